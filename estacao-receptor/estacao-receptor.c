@@ -6,14 +6,17 @@
 #include "lib/config_btn.h"
 #include "lib/task_display.h"
 #include "lib/task_LoRa.h"
+#include "lib/task_console.h"
 
 int main() {
     stdio_init_all();
     init_btn_callback();
 
     // Cria a tasks
+    xTaskCreate(vTaskLoRaIRQ, "LoRaIRQ", 512, NULL, 3, NULL);
     xTaskCreate(vTaskLoRaRX, "LoRa", 1024, NULL, 1, NULL);
     xTaskCreate(vTaskDisplay, "Display", 1024, NULL, 1, NULL);
+    xTaskCreate(vTaskConsole, "Console", 512, NULL, 1, NULL);
 
     // Inicia o agendador do FreeRTOS
     vTaskStartScheduler();
@@ -0,0 +1,37 @@
+#include "adr.h"
+
+void adr_init(adr_t *a, uint8_t sf, int8_t tx_power_dbm) {
+    a->sf = sf;
+    a->tx_power_dbm = tx_power_dbm;
+    a->snr_max_x4 = INT16_MIN;
+    a->count = 0;
+}
+
+// SF7 = -7,5 dB ... SF12 = -20 dB, 2,5 dB por SF (SF6 = -5 dB)
+int16_t adr_required_snr_x4(uint8_t sf) {
+    return (int16_t)(40 - 10 * (int16_t)sf);
+}
+
+bool adr_update(adr_t *a, int8_t snr_x4) {
+    if (snr_x4 > a->snr_max_x4) a->snr_max_x4 = snr_x4;
+    if (++a->count < ADR_WINDOW) return false;
+
+    int16_t margin_x4 = a->snr_max_x4 - adr_required_snr_x4(a->sf) - ADR_MARGIN_DB * 4;
+    int16_t step_x4 = ADR_STEP_DB * 4;
+    // Arredonda para baixo também quando negativo: qualquer falta pede um passo
+    int16_t steps = margin_x4 >= 0 ? margin_x4 / step_x4 : -((-margin_x4 + step_x4 - 1) / step_x4);
+
+    uint8_t sf = a->sf;
+    int8_t power = a->tx_power_dbm;
+    while (steps > 0 && sf > ADR_SF_MIN) { sf--; steps--; }
+    while (steps > 0 && power - ADR_STEP_DB >= ADR_POWER_MIN) { power -= ADR_STEP_DB; steps--; }
+    while (steps < 0 && power < ADR_POWER_MAX) {
+        power = power + ADR_STEP_DB > ADR_POWER_MAX ? ADR_POWER_MAX : power + ADR_STEP_DB;
+        steps++;
+    }
+    while (steps < 0 && sf < ADR_SF_MAX) { sf++; steps++; }
+
+    bool changed = sf != a->sf || power != a->tx_power_dbm;
+    adr_init(a, sf, power);
+    return changed;
+}
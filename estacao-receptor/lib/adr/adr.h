@@ -0,0 +1,40 @@
+#ifndef ADR_H
+#define ADR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Controle adaptativo de taxa (ADR) a partir da margem de SNR medida no receptor.
+// A cada ADR_WINDOW quadros compara o melhor SNR com o mínimo demodulável
+// no SF atual e converte a sobra (ou falta) em passos de ADR_STEP_DB:
+// sobra reduz primeiro o SF (menos tempo no ar) e depois a potência;
+// falta aumenta primeiro a potência e depois o SF.
+// Sem dependência do SDK.
+
+#define ADR_WINDOW      8     // Quadros por decisão
+#define ADR_MARGIN_DB   5     // Margem de instalação (desvanecimento) acima do mínimo
+#define ADR_STEP_DB     3     // Ganho aproximado de cada passo de SF ou de potência
+
+#define ADR_SF_MIN      7
+#define ADR_SF_MAX      12
+#define ADR_POWER_MIN   2     // dBm
+#define ADR_POWER_MAX   17    // dBm
+
+typedef struct {
+    uint8_t sf;
+    int8_t tx_power_dbm;
+    int16_t snr_max_x4;       // Melhor SNR da janela atual (0,25 dB)
+    uint8_t count;            // Quadros na janela atual
+} adr_t;
+
+// Começa (ou recomeça) a janela com os parâmetros em uso pelo nó
+void adr_init(adr_t *a, uint8_t sf, int8_t tx_power_dbm);
+
+// SNR mínimo para demodular no SF (0,25 dB), conforme o datasheet do SX1276
+int16_t adr_required_snr_x4(uint8_t sf);
+
+// Registra o SNR de um quadro. Retorna true quando a janela fecha com
+// novos valores em a->sf / a->tx_power_dbm.
+bool adr_update(adr_t *a, int8_t snr_x4);
+
+#endif
@@ -7,7 +7,7 @@
 
 // --- Handler único de interrupções dos botões ---
 void gpio_irq_handler(uint gpio, uint32_t events) {
-    reset_usb_boot(0, 0);
+    if (gpio == botaoB) reset_usb_boot(0, 0);
 }
 
 void init_btn_callback(){
@@ -0,0 +1,112 @@
+#include "link_stats.h"
+#include <string.h>
+
+#define RECENT_BITS 64
+
+void link_stats_init(link_stats_t *ls) {
+    memset(ls, 0, sizeof(*ls));
+}
+
+static uint8_t popcount64(uint64_t v) {
+    uint8_t n = 0;
+    while (v) {
+        v &= v - 1;
+        n++;
+    }
+    return n;
+}
+
+// Começa (ou recomeça) o acompanhamento em 'seq'
+static void link_stats_restart(link_stats_t *ls, uint16_t seq) {
+    ls->started = true;
+    ls->expected = (uint16_t)(seq + 1);
+    ls->recent = 1;
+    ls->recent_len = 1;
+    ls->received++;
+}
+
+static link_seq_result_t link_stats_seq(link_stats_t *ls, uint16_t seq) {
+    if (!ls->started) {
+        link_stats_restart(ls, seq);
+        return LINK_SEQ_NEW;
+    }
+
+    int32_t diff = (int16_t)(seq - ls->expected);
+
+    if (diff >= 0) {
+        if (diff > LINK_STATS_RESTART_GAP) {
+            ls->restarts++;
+            link_stats_restart(ls, seq);
+            return LINK_SEQ_RESTART;
+        }
+        // Avança a janela: as 'diff' sequências puladas ficam como perdidas
+        uint32_t shift = (uint32_t)diff + 1;
+        ls->recent = shift >= RECENT_BITS ? 0 : ls->recent << shift;
+        ls->recent |= 1;
+        ls->recent_len = (uint8_t)((ls->recent_len + shift) > RECENT_BITS ? RECENT_BITS : ls->recent_len + shift);
+        ls->lost += (uint32_t)diff;
+        ls->received++;
+        ls->expected = (uint16_t)(seq + 1);
+        return LINK_SEQ_NEW;
+    }
+
+    uint32_t age = (uint32_t)(-diff) - 1;   // 0 = última sequência aceita
+    if (age >= RECENT_BITS) {
+        if (-diff > LINK_STATS_RESTART_GAP) {
+            ls->restarts++;
+            link_stats_restart(ls, seq);
+            return LINK_SEQ_RESTART;
+        }
+        ls->duplicates++;   // Velha demais para decidir: não conta como nova
+        return LINK_SEQ_DUPLICATE;
+    }
+    if (ls->recent & ((uint64_t)1 << age)) {
+        ls->duplicates++;
+        return LINK_SEQ_DUPLICATE;
+    }
+
+    // Preenche uma lacuna que já tinha sido contada como perda
+    ls->recent |= (uint64_t)1 << age;
+    if (ls->lost) ls->lost--;
+    ls->received++;
+    ls->out_of_order++;
+    return LINK_SEQ_LATE;
+}
+
+link_seq_result_t link_stats_update(link_stats_t *ls, uint16_t seq, uint8_t count, uint32_t now_ms) {
+    bool first_frame = ls->received == 0 && !ls->started;
+    link_seq_result_t result = link_stats_seq(ls, seq);
+    for (uint8_t i = 1; i < count; i++) {
+        link_stats_seq(ls, (uint16_t)(seq + i));
+    }
+
+    // Intervalo entre quadros e jitter (médias móveis com peso 1/16)
+    if (!first_frame && result != LINK_SEQ_DUPLICATE) {
+        uint32_t interval_x16 = (now_ms - ls->last_arrival_ms) << 4;
+        if (ls->interval_avg_x16 == 0) {
+            ls->interval_avg_x16 = interval_x16;
+        } else {
+            int32_t dev = (int32_t)interval_x16 - (int32_t)ls->interval_avg_x16;
+            ls->interval_avg_x16 = (uint32_t)((int32_t)ls->interval_avg_x16 + dev / 16);
+            if (dev < 0) dev = -dev;
+            ls->jitter_x16 = (uint32_t)((int32_t)ls->jitter_x16 + (dev - (int32_t)ls->jitter_x16) / 16);
+        }
+    }
+    if (result != LINK_SEQ_DUPLICATE) ls->last_arrival_ms = now_ms;
+    return result;
+}
+
+uint16_t link_stats_per_permille(const link_stats_t *ls) {
+    if (ls->recent_len == 0) return 0;
+    uint64_t mask = ls->recent_len >= RECENT_BITS ? ~(uint64_t)0 : (((uint64_t)1 << ls->recent_len) - 1);
+    uint8_t got = popcount64(ls->recent & mask);
+    return (uint16_t)((uint32_t)(ls->recent_len - got) * 1000u / ls->recent_len);
+}
+
+uint32_t link_stats_interval_ms(const link_stats_t *ls) {
+    return ls->interval_avg_x16 >> 4;
+}
+
+uint32_t link_stats_jitter_ms(const link_stats_t *ls) {
+    return ls->jitter_x16 >> 4;
+}
@@ -0,0 +1,50 @@
+#ifndef LINK_STATS_H
+#define LINK_STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Estatísticas do enlace a partir dos números de sequência recebidos.
+// Sem dependência do SDK: o instante de chegada é passado pelo chamador.
+
+// Saltos de sequência maiores que isto são tratados como reinício do transmissor
+#define LINK_STATS_RESTART_GAP 1024
+
+typedef enum {
+    LINK_SEQ_NEW = 0,       // Sequência nova (em ordem ou após uma lacuna)
+    LINK_SEQ_LATE,          // Chegou depois de uma sequência maior (fora de ordem)
+    LINK_SEQ_DUPLICATE,     // Já recebida
+    LINK_SEQ_RESTART,       // Transmissor reiniciou a contagem
+} link_seq_result_t;
+
+typedef struct {
+    bool started;
+    uint16_t expected;          // Próxima sequência esperada
+    uint64_t recent;            // Bit i = sequência (expected - 1 - i) recebida
+    uint8_t recent_len;         // Quantas posições de 'recent' já são válidas
+
+    uint32_t received;          // Sequências distintas recebidas
+    uint32_t lost;              // Lacunas ainda não preenchidas
+    uint32_t duplicates;
+    uint32_t out_of_order;
+    uint32_t restarts;
+
+    uint32_t last_arrival_ms;
+    uint32_t interval_avg_x16;  // Média móvel do intervalo entre quadros (ms * 16)
+    uint32_t jitter_x16;        // Média móvel do desvio do intervalo (ms * 16)
+} link_stats_t;
+
+void link_stats_init(link_stats_t *ls);
+
+// Contabiliza um quadro com 'count' sequências consecutivas a partir de 'seq'
+// (1 para leitura única, N para lote). Retorna a classificação da primeira.
+link_seq_result_t link_stats_update(link_stats_t *ls, uint16_t seq, uint8_t count, uint32_t now_ms);
+
+// Taxa de perda nas últimas 64 sequências, em por mil
+uint16_t link_stats_per_permille(const link_stats_t *ls);
+
+// Intervalo médio entre quadros e jitter (variação média do intervalo), em ms
+uint32_t link_stats_interval_ms(const link_stats_t *ls);
+uint32_t link_stats_jitter_ms(const link_stats_t *ls);
+
+#endif
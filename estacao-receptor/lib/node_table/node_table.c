@@ -0,0 +1,51 @@
+#include "node_table.h"
+#include <string.h>
+
+// Hash multiplicativo (Fibonacci): espalha ids consecutivos pela tabela
+static inline uint32_t node_table_hash(uint8_t node_id) {
+    return ((uint32_t)node_id * 2654435761u) >> (32 - NODE_TABLE_BITS);
+}
+
+void node_table_init(node_table_t *t) {
+    memset(t, 0, sizeof(*t));
+}
+
+// Slot do nó ou o primeiro livre da sequência de sondagem
+static node_entry_t *node_table_probe(node_table_t *t, uint8_t node_id) {
+    uint32_t i = node_table_hash(node_id);
+    for (uint32_t n = 0; n < NODE_TABLE_CAPACITY; n++) {
+        node_entry_t *e = &t->entries[i];
+        if (!e->used || e->node_id == node_id) return e;
+        i = (i + 1) & (NODE_TABLE_CAPACITY - 1);
+    }
+    return NULL;
+}
+
+node_entry_t *node_table_find(node_table_t *t, uint8_t node_id) {
+    node_entry_t *e = node_table_probe(t, node_id);
+    return (e && e->used) ? e : NULL;
+}
+
+node_entry_t *node_table_insert(node_table_t *t, uint8_t node_id, uint32_t now_ms, bool *created) {
+    node_entry_t *e = node_table_probe(t, node_id);
+    *created = false;
+    if (e && e->used) return e;
+    if (!e || t->count >= NODE_TABLE_MAX_NODES) return NULL;
+
+    memset(e, 0, sizeof(*e));
+    e->used = true;
+    e->node_id = node_id;
+    e->first_seen_ms = now_ms;
+    e->last_seen_ms = now_ms;
+    link_stats_init(&e->link);
+    t->count++;
+    *created = true;
+    return e;
+}
+
+int node_table_next(const node_table_t *t, int from) {
+    for (int i = from < 0 ? 0 : from; i < (int)NODE_TABLE_CAPACITY; i++) {
+        if (t->entries[i].used) return i;
+    }
+    return -1;
+}
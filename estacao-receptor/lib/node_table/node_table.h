@@ -0,0 +1,58 @@
+#ifndef NODE_TABLE_H
+#define NODE_TABLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "link_stats.h"
+#include "adr.h"
+
+// Estado por estação de campo no receptor: tabela hash de endereçamento
+// aberto (sondagem linear) indexada pelo id do nó. Capacidade fixa, sem
+// alocação dinâmica e sem remoção: cada nó ocupa sempre o mesmo slot, então
+// um índice obtido uma vez continua válido.
+// Sem dependência do SDK.
+
+#define NODE_TABLE_BITS      6
+#define NODE_TABLE_CAPACITY  (1u << NODE_TABLE_BITS)
+// Ocupação máxima de 3/4 mantém as sondagens curtas
+#define NODE_TABLE_MAX_NODES (NODE_TABLE_CAPACITY * 3 / 4)
+
+typedef struct {
+    bool used;
+    uint8_t node_id;
+    uint32_t first_seen_ms;
+    uint32_t last_seen_ms;
+
+    // Última leitura (amostra mais recente do último quadro)
+    uint8_t flags;
+    uint8_t last_count;       // Sequências no último quadro (passo até o próximo)
+    uint16_t last_seq;
+    int16_t temp_cdeg;
+    uint16_t humidity_cpct;
+    uint32_t pressure_pa;
+
+    // Enlace
+    int16_t rssi_dbm;
+    int8_t snr_x4;
+    link_stats_t link;        // Janela de sequências, perdas e jitter
+    adr_t adr;                // SF e potência em uso pelo nó
+} node_entry_t;
+
+typedef struct {
+    node_entry_t entries[NODE_TABLE_CAPACITY];
+    uint8_t count;
+} node_table_t;
+
+void node_table_init(node_table_t *t);
+
+// Entrada do nó ou NULL se ainda não foi visto
+node_entry_t *node_table_find(node_table_t *t, uint8_t node_id);
+
+// Entrada do nó, criando-a (zerada, com link_stats iniciado) se necessário.
+// NULL se a tabela já tem NODE_TABLE_MAX_NODES nós. '*created' indica criação.
+node_entry_t *node_table_insert(node_table_t *t, uint8_t node_id, uint32_t now_ms, bool *created);
+
+// Índice do próximo slot ocupado a partir de 'from', ou -1 (para iterar a tabela)
+int node_table_next(const node_table_t *t, int from);
+
+#endif
@@ -0,0 +1,46 @@
+#include "rx_ring.h"
+
+// Os índices crescem livremente e são reduzidos com 'mask' no acesso;
+// head - tail é a ocupação mesmo após o estouro de 32 bits.
+// Acquire/release garante que o conteúdo do slot seja visível antes do índice.
+
+bool rx_ring_init(rx_ring_t *r, uint32_t size) {
+    if (size == 0 || (size & (size - 1)) != 0) return false;
+    r->head = 0;
+    r->tail = 0;
+    r->mask = size - 1;
+    r->dropped = 0;
+    r->high_water = 0;
+    return true;
+}
+
+int32_t rx_ring_reserve(rx_ring_t *r) {
+    uint32_t head = r->head;
+    uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+    if (head - tail > r->mask) {
+        r->dropped++;
+        return -1;
+    }
+    return (int32_t)(head & r->mask);
+}
+
+void rx_ring_commit(rx_ring_t *r) {
+    uint32_t head = r->head + 1;
+    uint32_t used = head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+    if (used > r->high_water) r->high_water = used;
+    __atomic_store_n(&r->head, head, __ATOMIC_RELEASE);
+}
+
+int32_t rx_ring_peek(const rx_ring_t *r) {
+    uint32_t tail = r->tail;
+    if (__atomic_load_n(&r->head, __ATOMIC_ACQUIRE) == tail) return -1;
+    return (int32_t)(tail & r->mask);
+}
+
+void rx_ring_release(rx_ring_t *r) {
+    __atomic_store_n(&r->tail, r->tail + 1, __ATOMIC_RELEASE);
+}
+
+uint32_t rx_ring_count(const rx_ring_t *r) {
+    return __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,35 @@
+#ifndef RX_RING_H
+#define RX_RING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Fila circular sem trava para um produtor e um consumidor (SPSC).
+// Só controla os índices: os slots ficam em um vetor do chamador com
+// 'size' posições (potência de 2). O produtor escreve apenas 'head' e o
+// consumidor apenas 'tail', então nenhum dos lados precisa de seção crítica.
+typedef struct {
+    volatile uint32_t head;     // Próximo slot a escrever (produtor)
+    volatile uint32_t tail;     // Próximo slot a ler (consumidor)
+    uint32_t mask;              // size - 1
+    uint32_t dropped;           // Quadros descartados com a fila cheia (produtor)
+    uint32_t high_water;        // Maior ocupação observada (produtor)
+} rx_ring_t;
+
+// Retorna false se 'size' não for potência de 2
+bool rx_ring_init(rx_ring_t *r, uint32_t size);
+
+// Produtor: índice do slot livre para preencher, ou -1 se a fila estiver cheia
+// (o descarte é contado em 'dropped'). rx_ring_commit() publica o slot.
+int32_t rx_ring_reserve(rx_ring_t *r);
+void rx_ring_commit(rx_ring_t *r);
+
+// Consumidor: índice do slot mais antigo, ou -1 se vazia.
+// rx_ring_release() devolve o slot ao produtor.
+int32_t rx_ring_peek(const rx_ring_t *r);
+void rx_ring_release(rx_ring_t *r);
+
+// Ocupação atual (aproximada se lida por um terceiro)
+uint32_t rx_ring_count(const rx_ring_t *r);
+
+#endif
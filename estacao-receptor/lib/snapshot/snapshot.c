@@ -0,0 +1,38 @@
+#include "snapshot.h"
+#include <string.h>
+
+// 'seq' só é escrito pelo escritor. Release na publicação garante que o
+// buffer esteja completo antes do novo 'seq'; o fence acquire no leitor
+// impede que a releitura de 'seq' seja adiantada para antes da cópia.
+// Depois de publicar N+1 o escritor pode começar a sobrescrever buf[N & 1],
+// então qualquer mudança de 'seq' durante a cópia a invalida.
+
+void snapshot_init(snapshot_t *s) {
+    memset(s->buf, 0, sizeof(s->buf));
+    __atomic_store_n(&s->seq, 0, __ATOMIC_RELEASE);
+}
+
+uint32_t snapshot_publish(snapshot_t *s, const snapshot_record_t *r) {
+    uint32_t seq = s->seq + 1;
+    snapshot_record_t *b = &s->buf[seq & 1];
+    *b = *r;
+    b->seq = seq;
+    __atomic_store_n(&s->seq, seq, __ATOMIC_RELEASE);
+    return seq;
+}
+
+bool snapshot_read(const snapshot_t *s, snapshot_record_t *out) {
+    uint32_t seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+    for (;;) {
+        if (seq == 0) return false;
+        *out = s->buf[seq & 1];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint32_t now = __atomic_load_n(&s->seq, __ATOMIC_RELAXED);
+        if (now == seq) return true;
+        seq = now;
+    }
+}
+
+uint32_t snapshot_seq(const snapshot_t *s) {
+    return __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+}
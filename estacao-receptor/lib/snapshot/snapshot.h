@@ -0,0 +1,31 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "snapshot_record.h"
+
+// Registro publicado por um escritor e copiado sem trava por qualquer número
+// de leitores (seqlock com dois buffers). O escritor preenche o buffer que os
+// leitores não estão usando e só então avança 'seq'; o leitor copia o buffer
+// indicado por 'seq' e repete a cópia se 'seq' mudou no meio. Como o buffer
+// atual nunca está sendo escrito, um leitor de prioridade mais alta que
+// interrompa o escritor copia a publicação anterior em vez de girar à espera.
+// Zerado = nada publicado. Um único escritor por snapshot.
+typedef struct {
+    volatile uint32_t seq;      // Publicações feitas; buf[seq & 1] é a atual
+    snapshot_record_t buf[2];
+} snapshot_t;
+
+void snapshot_init(snapshot_t *s);
+
+// Escritor: publica uma cópia de '*r' e retorna o número da publicação
+uint32_t snapshot_publish(snapshot_t *s, const snapshot_record_t *r);
+
+// Leitor: copia o registro mais recente. Retorna false se nada foi publicado.
+bool snapshot_read(const snapshot_t *s, snapshot_record_t *out);
+
+// Número da publicação mais recente (0 = nenhuma), sem copiar o registro
+uint32_t snapshot_seq(const snapshot_t *s);
+
+#endif
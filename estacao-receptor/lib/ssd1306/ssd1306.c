@@ -1,5 +1,6 @@
 #include "ssd1306.h"
 #include "font.h"
+#include "i2c_bus.h"
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
   ssd->width = width;
@@ -43,12 +44,11 @@ void ssd1306_config(ssd1306_t *ssd) {
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   ssd->port_buffer[1] = command;
-  i2c_write_blocking(
+  i2c_bus_write(
     ssd->i2c_port,
     ssd->address,
     ssd->port_buffer,
-    2,
-    false
+    2
   );
 }
 
@@ -59,12 +59,12 @@ void ssd1306_send_data(ssd1306_t *ssd) {
   ssd1306_command(ssd, SET_PAGE_ADDR);
   ssd1306_command(ssd, 0);
   ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
+  // Framebuffer (~25 ms a 400 kHz) por DMA: a task dorme durante o envio
+  i2c_bus_write(
     ssd->i2c_port,
     ssd->address,
     ssd->ram_buffer,
-    ssd->bufsize,
-    false
+    ssd->bufsize
   );
 }
 
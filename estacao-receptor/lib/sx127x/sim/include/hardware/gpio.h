@@ -0,0 +1,25 @@
+// Substituto de hardware/gpio.h: CS e RST chegam ao rádio selecionado e a
+// borda do DIO0 é gerada pelo emulador (sx127x_emu.c)
+#ifndef SIM_HARDWARE_GPIO_H
+#define SIM_HARDWARE_GPIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GPIO_FUNC_SPI      1
+#define GPIO_IN            false
+#define GPIO_OUT           true
+#define GPIO_IRQ_EDGE_RISE 0x8u
+
+typedef void (*irq_handler_t)(void);
+
+void gpio_init(unsigned int gpio);
+void gpio_set_function(unsigned int gpio, int fn);
+void gpio_set_dir(unsigned int gpio, bool out);
+void gpio_put(unsigned int gpio, bool value);
+void gpio_add_raw_irq_handler(unsigned int gpio, irq_handler_t handler);
+void gpio_set_irq_enabled(unsigned int gpio, uint32_t events, bool enabled);
+uint32_t gpio_get_irq_event_mask(unsigned int gpio);
+void gpio_acknowledge_irq(unsigned int gpio, uint32_t events);
+
+#endif
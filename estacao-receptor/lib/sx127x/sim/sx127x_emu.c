@@ -0,0 +1,596 @@
+// sx127x_emu.c — SX1276 emulado em nível de registradores e canal de rádio
+// compartilhado (ver sx127x_emu.h). Implementa também as funções do SDK que o
+// sx127x.c usa (sim/include): SPI, GPIO e relógio, todos em tempo simulado.
+
+#include "sx127x_emu.h"
+#include "sx127x.h"
+#include "hardware/spi.h"
+#include "hardware/gpio.h"
+#include "pico/time.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Pinos do sx127x.c
+#define EMU_PIN_CS    17
+#define EMU_PIN_RST   20
+#define EMU_PIN_DIO0  8
+
+// Registradores usados pelo driver
+#define REG_FIFO            0x00
+#define REG_OP_MODE         0x01
+#define REG_FRF_MSB         0x06
+#define REG_FIFO_ADDR_PTR   0x0D
+#define REG_FIFO_TX_BASE    0x0E
+#define REG_FIFO_RX_BASE    0x0F
+#define REG_FIFO_RX_CURRENT 0x10
+#define REG_IRQ_FLAGS       0x12
+#define REG_RX_NB_BYTES     0x13
+#define REG_PKT_SNR         0x19
+#define REG_PKT_RSSI        0x1A
+#define REG_HOP_CHANNEL     0x1C
+#define REG_MODEM_CONFIG1   0x1D
+#define REG_MODEM_CONFIG2   0x1E
+#define REG_PREAMBLE_MSB    0x20
+#define REG_PREAMBLE_LSB    0x21
+#define REG_PAYLOAD_LEN     0x22
+#define REG_MODEM_CONFIG3   0x26
+#define REG_FEI_MSB         0x28
+#define REG_DIO_MAPPING_1   0x40
+#define REG_VERSION         0x42
+
+// Bits 2-0 de REG_OP_MODE
+#define MODE_SLEEP   0
+#define MODE_STDBY   1
+#define MODE_TX      3
+#define MODE_RX      5
+#define MODE_CAD     7
+
+// Transmissões guardadas por mais tempo que o maior pacote (SF12, 255 B)
+#define EMU_MAX_AIR      1024
+#define EMU_AIR_KEEP_US  (30ull * 1000 * 1000)
+
+typedef struct {
+    bool used;
+    bool aborted;
+    uint8_t radio;
+    uint8_t frf[3];
+    uint8_t sf;
+    uint8_t bw;
+    bool crc_on;
+    int16_t rssi_dbm;
+    uint64_t start_us;
+    uint64_t sync_us;         // Último instante em que um receptor ainda sincroniza
+    uint64_t end_us;
+    uint8_t len;
+    uint8_t data[256];
+} emu_air_t;
+
+typedef struct {
+    uint8_t reg[128];
+    uint8_t fifo[256];
+    bool in_reset;
+    bool edge;                // Borda de DIO0 ainda não reconhecida
+    int tx;                   // Transmissão própria em andamento (-1: nenhuma)
+    int lock;                 // Transmissão sendo recebida (-1: nenhuma)
+    uint64_t cad_start_us;
+    uint64_t cad_end_us;
+    uint64_t mode_since_us;
+    int16_t rssi_dbm;
+    uint8_t loss_pct;
+    emu_radio_stats_t stats;
+} emu_radio_t;
+
+static emu_radio_t radios[EMU_MAX_RADIOS];
+static uint8_t radio_count;
+static uint8_t selected;
+static emu_air_t air[EMU_MAX_AIR];
+static uint64_t now_us;
+static uint32_t rng;
+
+// Estado do SPI (um MCU ativo por vez: o do rádio selecionado)
+static bool cs_low;
+static bool have_addr;
+static uint8_t spi_addr;
+static size_t spi_bytes;
+static unsigned int spi_baud = 1000000;
+
+static irq_handler_t dio0_handler;
+static bool dio0_enabled;
+
+static uint32_t emu_rand(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+// === Registradores ===
+static void emu_reset(emu_radio_t *r) {
+    memset(r->reg, 0, sizeof(r->reg));
+    memset(r->fifo, 0, sizeof(r->fifo));
+    r->reg[REG_OP_MODE] = 0x09;                        // FSK, standby
+    r->reg[REG_FRF_MSB] = 0x6C;                        // 434 MHz
+    r->reg[REG_FRF_MSB + 1] = 0x80;
+    r->reg[REG_FIFO_TX_BASE] = 0x80;
+    r->reg[REG_MODEM_CONFIG1] = 0x72;
+    r->reg[REG_MODEM_CONFIG2] = 0x70;
+    r->reg[REG_PREAMBLE_LSB] = 0x08;
+    r->reg[REG_PAYLOAD_LEN] = 0x01;
+    r->reg[REG_VERSION] = 0x12;
+    r->edge = false;
+    r->tx = -1;
+    r->lock = -1;
+}
+
+static uint8_t emu_mode(const emu_radio_t *r) {
+    return r->reg[REG_OP_MODE] & 0x07;
+}
+
+static bool emu_lora(const emu_radio_t *r) {
+    return (r->reg[REG_OP_MODE] & 0x80) != 0;
+}
+
+// Perfil equivalente ao que está nos registradores (para tempo no ar e CAD)
+static void emu_profile(const emu_radio_t *r, sx127x_profile_t *p) {
+    const uint8_t *reg = r->reg;
+    uint32_t frf = ((uint32_t)reg[REG_FRF_MSB] << 16) | ((uint32_t)reg[REG_FRF_MSB + 1] << 8) | reg[REG_FRF_MSB + 2];
+    memset(p, 0, sizeof(*p));
+    p->frequency_hz = (uint32_t)(((uint64_t)frf * 32000000u) >> 19);
+    p->bw = (sx127x_bw_t)(reg[REG_MODEM_CONFIG1] >> 4);
+    p->cr = (reg[REG_MODEM_CONFIG1] >> 1) & 0x07;
+    p->implicit_header = reg[REG_MODEM_CONFIG1] & 0x01;
+    p->sf = reg[REG_MODEM_CONFIG2] >> 4;
+    p->crc_on = (reg[REG_MODEM_CONFIG2] & 0x04) != 0;
+    p->preamble_len = (uint16_t)((reg[REG_PREAMBLE_MSB] << 8) | reg[REG_PREAMBLE_LSB]);
+    p->payload_len = reg[REG_PAYLOAD_LEN];
+    p->ldro = (reg[REG_MODEM_CONFIG3] & 0x08) ? SX127X_LDRO_ON : SX127X_LDRO_OFF;
+}
+
+static bool emu_same_channel(const emu_radio_t *r, const emu_air_t *a) {
+    return memcmp(&r->reg[REG_FRF_MSB], a->frf, sizeof(a->frf)) == 0 &&
+           (r->reg[REG_MODEM_CONFIG2] >> 4) == a->sf &&
+           (r->reg[REG_MODEM_CONFIG1] >> 4) == a->bw;
+}
+
+// SNR (0,25 dB) de um sinal de 'rssi_dbm' no piso de ruído da banda
+static int emu_snr_x4(const sx127x_profile_t *p, int16_t rssi_dbm) {
+    double noise = -174.0 + 10.0 * log10((double)sx127x_bandwidth_hz(p)) + EMU_NOISE_FIGURE;
+    return (int)lround((rssi_dbm - noise) * 4.0);
+}
+
+// Limite de demodulação do datasheet: -5 dB no SF6, -2,5 dB por SF acima
+static bool emu_demodulates(const sx127x_profile_t *p, int16_t rssi_dbm) {
+    return emu_snr_x4(p, rssi_dbm) >= -20 - 10 * (p->sf - 6);
+}
+
+// === DIO0 ===
+static bool emu_dio0_level(const emu_radio_t *r) {
+    static const uint8_t mapped[4] = {
+        SX127X_IRQ_RX_DONE, SX127X_IRQ_TX_DONE, SX127X_IRQ_CAD_DONE, 0,
+    };
+    return (r->reg[REG_IRQ_FLAGS] & mapped[r->reg[REG_DIO_MAPPING_1] >> 6]) != 0;
+}
+
+// Sobe flags de interrupção; retorna true se gerou borda e o tratador rodou
+static bool emu_raise(uint8_t idx, uint8_t flags) {
+    emu_radio_t *r = &radios[idx];
+    bool before = emu_dio0_level(r);
+    r->reg[REG_IRQ_FLAGS] |= flags;
+    if (before || !emu_dio0_level(r)) return false;
+
+    r->edge = true;
+    if (!dio0_enabled || !dio0_handler) return false;
+    uint8_t saved = selected;
+    selected = idx;                                    // A ISR roda no MCU desse rádio
+    dio0_handler();
+    selected = saved;
+    return true;
+}
+
+// === Canal ===
+static int emu_air_alloc(void) {
+    for (int i = 0; i < EMU_MAX_AIR; i++) {
+        emu_air_t *a = &air[i];
+        if (!a->used || a->end_us + EMU_AIR_KEEP_US < now_us) {
+            bool referenced = false;
+            for (uint8_t k = 0; a->used && k < radio_count; k++) {
+                referenced |= radios[k].lock == i || radios[k].tx == i;
+            }
+            if (!referenced) return i;
+        }
+    }
+    fprintf(stderr, "sx127x_emu: transmissões simultâneas demais (EMU_MAX_AIR)\n");
+    exit(2);
+}
+
+// Receptor em RX sem pacote: sincroniza com a transmissão mais forte que
+// ainda está no preâmbulo
+static void emu_try_lock(uint8_t idx) {
+    emu_radio_t *r = &radios[idx];
+    if (emu_mode(r) != MODE_RX || !emu_lora(r) || r->lock >= 0) return;
+
+    sx127x_profile_t p;
+    emu_profile(r, &p);
+    int best = -1;
+    for (int i = 0; i < EMU_MAX_AIR; i++) {
+        const emu_air_t *a = &air[i];
+        if (!a->used || a->aborted || a->radio == idx) continue;
+        if (a->start_us > now_us || a->sync_us < now_us) continue;
+        if (!emu_same_channel(r, a) || !emu_demodulates(&p, a->rssi_dbm)) continue;
+        if (best < 0 || a->rssi_dbm > air[best].rssi_dbm) best = i;
+    }
+    r->lock = best;
+}
+
+static void emu_start_tx(uint8_t idx) {
+    emu_radio_t *r = &radios[idx];
+    sx127x_profile_t p;
+    emu_profile(r, &p);
+
+    int i = emu_air_alloc();
+    emu_air_t *a = &air[i];
+    memset(a, 0, sizeof(*a));
+    a->used = true;
+    a->radio = idx;
+    memcpy(a->frf, &r->reg[REG_FRF_MSB], sizeof(a->frf));
+    a->sf = p.sf;
+    a->bw = (uint8_t)p.bw;
+    a->crc_on = p.crc_on;
+    a->rssi_dbm = r->rssi_dbm;
+    a->len = r->reg[REG_PAYLOAD_LEN];
+    for (uint16_t k = 0; k < a->len; k++) {
+        a->data[k] = r->fifo[(uint8_t)(r->reg[REG_FIFO_TX_BASE] + k)];
+    }
+
+    // Preâmbulo = n + 4,25 símbolos; o receptor precisa de alguns para sincronizar
+    uint32_t tsym = sx127x_symbol_time_us(&p);
+    uint32_t sync_syms = p.preamble_len + 4 > SX127X_SNIFF_LOCK_SYMBOLS
+                       ? p.preamble_len + 4 - SX127X_SNIFF_LOCK_SYMBOLS : 0;
+    a->start_us = now_us;
+    a->sync_us = now_us + (uint64_t)sync_syms * tsym;
+    a->end_us = now_us + sx127x_time_on_air_us(&p, a->len);
+    r->tx = i;
+    r->stats.tx_frames++;
+
+    for (uint8_t k = 0; k < radio_count; k++) {
+        if (k == idx) continue;
+        if (radios[k].lock >= 0 && emu_same_channel(&radios[k], a) && emu_mode(&radios[k]) == MODE_RX) {
+            radios[k].stats.rx_missed++;
+        }
+        emu_try_lock(k);
+    }
+}
+
+// Escrita em REG_OP_MODE: transições entre modos
+static void emu_set_mode(uint8_t idx, uint8_t value) {
+    emu_radio_t *r = &radios[idx];
+    uint8_t old = r->reg[REG_OP_MODE];
+
+    // LongRangeMode só muda em sleep
+    if (((old ^ value) & 0x80) && (old & 0x07) != MODE_SLEEP) {
+        value = (uint8_t)((value & 0x7F) | (old & 0x80));
+    }
+    uint8_t from = old & 0x07, to = value & 0x07;
+    r->reg[REG_OP_MODE] = value;
+    if (from == to) return;
+
+    r->stats.mode_us[from] += now_us - r->mode_since_us;
+    r->mode_since_us = now_us;
+
+    if (from == MODE_TX && r->tx >= 0) {
+        air[r->tx].aborted = true;
+        air[r->tx].end_us = now_us;
+        r->tx = -1;
+        r->stats.tx_aborted++;
+    }
+    if (from == MODE_RX) r->lock = -1;
+    if (!emu_lora(r)) return;
+
+    if (to == MODE_SLEEP) {
+        memset(r->fifo, 0, sizeof(r->fifo));           // FIFO não sobrevive ao sleep
+    } else if (to == MODE_TX) {
+        emu_start_tx(idx);
+    } else if (to == MODE_CAD) {
+        sx127x_profile_t p;
+        emu_profile(r, &p);
+        r->cad_start_us = now_us;
+        r->cad_end_us = now_us + sx127x_cad_time_us(&p);
+        r->stats.cad_runs++;
+    } else if (to == MODE_RX) {
+        emu_try_lock(idx);
+    }
+}
+
+// Volta para standby ao fim de TX/CAD, como o chip faz sozinho
+static void emu_auto_standby(emu_radio_t *r) {
+    r->stats.mode_us[emu_mode(r)] += now_us - r->mode_since_us;
+    r->mode_since_us = now_us;
+    r->reg[REG_OP_MODE] = (uint8_t)((r->reg[REG_OP_MODE] & 0xF8) | MODE_STDBY);
+}
+
+static bool emu_tx_done(uint8_t idx) {
+    emu_radio_t *r = &radios[idx];
+    r->tx = -1;
+    emu_auto_standby(r);
+    return emu_raise(idx, SX127X_IRQ_TX_DONE);
+}
+
+static bool emu_cad_done(uint8_t idx) {
+    emu_radio_t *r = &radios[idx];
+    sx127x_profile_t p;
+    emu_profile(r, &p);
+
+    bool detected = false;
+    for (int i = 0; i < EMU_MAX_AIR && !detected; i++) {
+        const emu_air_t *a = &air[i];
+        if (!a->used || a->radio == idx) continue;
+        if (a->start_us >= r->cad_end_us || a->end_us <= r->cad_start_us) continue;
+        detected = emu_same_channel(r, a) && emu_demodulates(&p, a->rssi_dbm);
+    }
+    r->cad_end_us = 0;
+    if (detected) r->stats.cad_detected++;
+    emu_auto_standby(r);
+    return emu_raise(idx, SX127X_IRQ_CAD_DONE | (detected ? SX127X_IRQ_CAD_DETECTED : 0));
+}
+
+// Fim do pacote que o receptor acompanhava
+static bool emu_rx_done(uint8_t idx) {
+    emu_radio_t *r = &radios[idx];
+    const emu_air_t *a = &air[r->lock];
+    int lock = r->lock;
+    r->lock = -1;
+
+    if (a->aborted || (uint32_t)(emu_rand() % 100) < radios[a->radio].loss_pct) {
+        r->stats.rx_faded++;
+        emu_try_lock(idx);
+        return false;
+    }
+
+    // Outra transmissão no mesmo canal sem margem de captura corrompe o pacote
+    bool corrupted = false;
+    for (int i = 0; i < EMU_MAX_AIR && !corrupted; i++) {
+        const emu_air_t *b = &air[i];
+        if (i == lock || !b->used || b->start_us >= a->end_us || b->end_us <= a->start_us) continue;
+        corrupted = emu_same_channel(r, b) && b->rssi_dbm > a->rssi_dbm - EMU_CAPTURE_DB;
+    }
+
+    sx127x_profile_t p;
+    emu_profile(r, &p);
+    uint8_t base = r->reg[REG_FIFO_RX_BASE];
+    for (uint16_t k = 0; k < a->len; k++) {
+        r->fifo[(uint8_t)(base + k)] = a->data[k];
+    }
+    if (corrupted && a->len) r->fifo[(uint8_t)(base + emu_rand() % a->len)] ^= 0x5A;
+
+    // PktSnr satura perto de +10 dB; PktRssi no formato que sx127x_read_link_quality desfaz
+    int snr = emu_snr_x4(&p, a->rssi_dbm);
+    if (snr > 40) snr = 40;
+    int offset = p.frequency_hz < 525000000u ? -164 : -157;
+    int pkt_rssi = snr >= 0 ? (a->rssi_dbm - offset) * 15 / 16 : a->rssi_dbm - offset - snr / 4;
+    if (pkt_rssi < 0) pkt_rssi = 0;
+    if (pkt_rssi > 255) pkt_rssi = 255;
+
+    r->reg[REG_FIFO_RX_CURRENT] = base;
+    r->reg[REG_RX_NB_BYTES] = a->len;
+    r->reg[REG_PKT_SNR] = (uint8_t)(int8_t)snr;
+    r->reg[REG_PKT_RSSI] = (uint8_t)pkt_rssi;
+    r->reg[REG_HOP_CHANNEL] = a->crc_on ? 0x40 : 0x00;
+    memset(&r->reg[REG_FEI_MSB], 0, 3);
+
+    uint8_t flags = SX127X_IRQ_RX_DONE | SX127X_IRQ_VALID_HEADER;
+    if (corrupted && a->crc_on) {
+        flags |= SX127X_IRQ_CRC_ERROR;
+        r->stats.rx_crc_error++;
+    } else {
+        r->stats.rx_ok++;
+    }
+    emu_try_lock(idx);                                 // Continua em RX contínuo
+    return emu_raise(idx, flags);
+}
+
+// === API ===
+void emu_init(uint8_t count, uint32_t seed) {
+    memset(radios, 0, sizeof(radios));
+    memset(air, 0, sizeof(air));
+    radio_count = count > EMU_MAX_RADIOS ? EMU_MAX_RADIOS : count;
+    for (uint8_t i = 0; i < radio_count; i++) {
+        emu_reset(&radios[i]);
+        radios[i].rssi_dbm = -80;
+    }
+    selected = 0;
+    now_us = 0;
+    rng = seed ? seed : 1;
+    cs_low = false;                                    // O tratador de DIO0 instalado pelo driver continua
+}
+
+void emu_select(uint8_t radio) {
+    if (radio < radio_count) selected = radio;
+}
+
+uint8_t emu_selected(void) {
+    return selected;
+}
+
+void emu_set_link(uint8_t radio, int16_t rssi_dbm, uint8_t loss_pct) {
+    if (radio >= radio_count) return;
+    radios[radio].rssi_dbm = rssi_dbm;
+    radios[radio].loss_pct = loss_pct > 100 ? 100 : loss_pct;
+}
+
+bool emu_run_until(uint64_t t_us) {
+    for (;;) {
+        // Próximo evento: fim de TX, de CAD ou do pacote em recepção
+        uint64_t next = UINT64_MAX;
+        uint8_t who = 0, kind = 0;
+        for (uint8_t i = 0; i < radio_count; i++) {
+            const emu_radio_t *r = &radios[i];
+            if (r->tx >= 0 && air[r->tx].end_us < next) { next = air[r->tx].end_us; who = i; kind = MODE_TX; }
+            if (r->cad_end_us && r->cad_end_us < next)  { next = r->cad_end_us; who = i; kind = MODE_CAD; }
+            if (r->lock >= 0 && air[r->lock].end_us < next) { next = air[r->lock].end_us; who = i; kind = MODE_RX; }
+        }
+        if (next > t_us) break;
+        if (next > now_us) now_us = next;
+
+        bool edge = kind == MODE_TX ? emu_tx_done(who)
+                  : kind == MODE_CAD ? emu_cad_done(who)
+                  : emu_rx_done(who);
+        if (edge) return true;
+    }
+    if (t_us > now_us) now_us = t_us;
+    return false;
+}
+
+uint64_t emu_now_us(void) {
+    return now_us;
+}
+
+const emu_radio_stats_t *emu_stats(uint8_t radio) {
+    static emu_radio_stats_t snapshot;
+    snapshot = radios[radio].stats;
+    snapshot.mode_us[emu_mode(&radios[radio])] += now_us - radios[radio].mode_since_us;
+    return &snapshot;
+}
+
+// === Relógio ===
+static void emu_advance(uint64_t dt_us) {
+    uint64_t target = now_us + dt_us;
+    while (emu_run_until(target)) {}
+}
+
+uint64_t time_us_64(void) {
+    return now_us;
+}
+
+uint32_t time_us_32(void) {
+    emu_advance(1);                                    // Laços de polling precisam andar
+    return (uint32_t)now_us;
+}
+
+void sleep_ms(uint32_t ms) {
+    emu_advance((uint64_t)ms * 1000);
+}
+
+// === SPI: byte de endereço (bit 7 = escrita) seguido de dados em rajada ===
+static uint8_t emu_spi_byte(uint8_t out) {
+    emu_radio_t *r = &radios[selected];
+    spi_bytes++;
+    if (r->in_reset) return 0;
+    if (!have_addr) {
+        spi_addr = out;
+        have_addr = true;
+        return 0;
+    }
+
+    bool write = (spi_addr & 0x80) != 0;
+    uint8_t addr = spi_addr & 0x7F;
+    uint8_t in = 0;
+    if (addr == REG_FIFO) {
+        // FIFO: acesso em FifoAddrPtr, que avança; inacessível em sleep
+        if (emu_mode(r) != MODE_SLEEP) {
+            uint8_t ptr = r->reg[REG_FIFO_ADDR_PTR]++;
+            if (write) r->fifo[ptr] = out;
+            else in = r->fifo[ptr];
+        }
+        return in;
+    }
+
+    if (write) {
+        switch (addr) {
+        case REG_OP_MODE:
+            emu_set_mode(selected, out);
+            break;
+        case REG_IRQ_FLAGS:
+            r->reg[addr] &= (uint8_t)~out;             // Escrever 1 limpa
+            break;
+        case REG_FIFO_RX_CURRENT: case REG_RX_NB_BYTES: case REG_PKT_SNR:
+        case REG_PKT_RSSI: case REG_PKT_RSSI + 1: case REG_HOP_CHANNEL: case REG_VERSION:
+            break;                                     // Só leitura
+        default:
+            r->reg[addr] = out;
+            break;
+        }
+    } else {
+        in = r->reg[addr];
+    }
+    spi_addr = (uint8_t)((spi_addr & 0x80) | ((addr + 1) & 0x7F));
+    return in;
+}
+
+unsigned int spi_init(spi_inst_t *spi, unsigned int baudrate) {
+    (void)spi;
+    spi_baud = baudrate;
+    return spi_baud;
+}
+
+unsigned int spi_set_baudrate(spi_inst_t *spi, unsigned int baudrate) {
+    return spi_init(spi, baudrate);
+}
+
+unsigned int spi_get_baudrate(const spi_inst_t *spi) {
+    (void)spi;
+    return spi_baud;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len) {
+    (void)spi;
+    for (size_t i = 0; i < len; i++) emu_spi_byte(src[i]);
+    return (int)len;
+}
+
+int spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx, uint8_t *dst, size_t len) {
+    (void)spi;
+    for (size_t i = 0; i < len; i++) dst[i] = emu_spi_byte(repeated_tx);
+    return (int)len;
+}
+
+int spi_write_read_blocking(spi_inst_t *spi, const uint8_t *src, uint8_t *dst, size_t len) {
+    (void)spi;
+    for (size_t i = 0; i < len; i++) dst[i] = emu_spi_byte(src[i]);
+    return (int)len;
+}
+
+// === GPIO ===
+void gpio_init(unsigned int gpio) { (void)gpio; }
+void gpio_set_function(unsigned int gpio, int fn) { (void)gpio; (void)fn; }
+void gpio_set_dir(unsigned int gpio, bool out) { (void)gpio; (void)out; }
+
+void gpio_put(unsigned int gpio, bool value) {
+    emu_radio_t *r = &radios[selected];
+    if (gpio == EMU_PIN_RST) {
+        if (!value) {
+            r->in_reset = true;
+        } else if (r->in_reset) {
+            r->in_reset = false;
+            emu_reset(r);
+            r->mode_since_us = now_us;
+        }
+    } else if (gpio == EMU_PIN_CS) {
+        if (!value) {
+            cs_low = true;
+            have_addr = false;
+            spi_bytes = 0;
+        } else if (cs_low) {
+            // Fim da transação: o tempo de barramento passa e o canal anda junto
+            cs_low = false;
+            emu_advance(1 + (spi_bytes * 8 * 1000000u + spi_baud - 1) / spi_baud);
+        }
+    }
+}
+
+void gpio_add_raw_irq_handler(unsigned int gpio, irq_handler_t handler) {
+    if (gpio == EMU_PIN_DIO0) dio0_handler = handler;
+}
+
+void gpio_set_irq_enabled(unsigned int gpio, uint32_t events, bool enabled) {
+    if (gpio == EMU_PIN_DIO0 && (events & GPIO_IRQ_EDGE_RISE)) dio0_enabled = enabled;
+}
+
+uint32_t gpio_get_irq_event_mask(unsigned int gpio) {
+    return gpio == EMU_PIN_DIO0 && radios[selected].edge ? GPIO_IRQ_EDGE_RISE : 0;
+}
+
+void gpio_acknowledge_irq(unsigned int gpio, uint32_t events) {
+    if (gpio == EMU_PIN_DIO0 && (events & GPIO_IRQ_EDGE_RISE)) radios[selected].edge = false;
+}
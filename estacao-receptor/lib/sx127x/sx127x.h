@@ -4,14 +4,206 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-// Inicializa SPI, GPIOs e configura o módulo LoRa
+// Flags de REG_IRQ_FLAGS
+#define SX127X_IRQ_RX_TIMEOUT     0x80
+#define SX127X_IRQ_RX_DONE        0x40
+#define SX127X_IRQ_CRC_ERROR      0x20
+#define SX127X_IRQ_VALID_HEADER   0x10
+#define SX127X_IRQ_TX_DONE        0x08
+#define SX127X_IRQ_CAD_DONE       0x04
+#define SX127X_IRQ_FHSS_CHANGE    0x02
+#define SX127X_IRQ_CAD_DETECTED   0x01
+
+// Chamado em contexto de interrupção a cada borda de subida do DIO0
+typedef void (*sx127x_dio0_callback_t)(void);
+
+// Largura de banda (código de REG_MODEM_CONFIG1)
+typedef enum {
+    SX127X_BW_7K8 = 0,
+    SX127X_BW_10K4,
+    SX127X_BW_15K6,
+    SX127X_BW_20K8,
+    SX127X_BW_31K25,
+    SX127X_BW_41K7,
+    SX127X_BW_62K5,
+    SX127X_BW_125K,
+    SX127X_BW_250K,
+    SX127X_BW_500K,
+} sx127x_bw_t;
+
+// Low Data Rate Optimize: AUTO liga quando o símbolo passa de 16 ms
+typedef enum {
+    SX127X_LDRO_AUTO = 0,
+    SX127X_LDRO_OFF,
+    SX127X_LDRO_ON,
+} sx127x_ldro_t;
+
+// Perfil de rádio: tudo o que precisa ser igual nas duas pontas do enlace
+typedef struct {
+    uint32_t frequency_hz;    // Portadora (Hz)
+    uint8_t sf;               // Spreading factor: 6..12
+    sx127x_bw_t bw;           // Largura de banda
+    uint8_t cr;               // Coding rate: 1..4 (4/5..4/8)
+    int8_t tx_power_dbm;      // 2..17 dBm, ou 20 dBm (PA_DAC)
+    uint16_t preamble_len;    // Símbolos de preâmbulo (mínimo 6)
+    bool crc_on;              // CRC do payload gerado/verificado pelo rádio
+    bool implicit_header;     // Header implícito (comprimento fixo em payload_len)
+    uint8_t payload_len;      // Comprimento fixo em header implícito (0 = não usado)
+    sx127x_ldro_t ldro;
+} sx127x_profile_t;
+
+// Definição única usada pelo transmissor e pelo receptor
+#define SX127X_PROFILE_DEFAULT {        \
+    .frequency_hz = 915000000,          \
+    .sf = 7,                            \
+    .bw = SX127X_BW_125K,               \
+    .cr = 1,                            \
+    .tx_power_dbm = 17,                 \
+    .preamble_len = 8,                  \
+    .crc_on = true,                     \
+    .implicit_header = false,           \
+    .payload_len = 0,                   \
+    .ldro = SX127X_LDRO_AUTO,           \
+}
+
+extern const sx127x_profile_t sx127x_profile_default;
+
+// Recepção por amostragem (sniff): com SX127X_SNIFF_PERIOD_MS > 0 o receptor
+// pode dormir entre CADs espaçados desse período, e a task de rádio de cada
+// estação estende o preâmbulo dos perfis que aplica para cobrir o período no
+// SF/BW do perfil (sx127x_sniff_preamble_len). Vale para as duas estações.
+#ifndef SX127X_SNIFF_PERIOD_MS
+#define SX127X_SNIFF_PERIOD_MS 0
+#endif
+#define SX127X_SNIFF_CAD_SYMBOLS    2   // Duração de um CAD (arredondada para cima)
+#define SX127X_SNIFF_LOCK_SYMBOLS   5   // Preâmbulo restante para sincronizar após o CAD
+
+// Plano de canais para saltos de frequência (sx127x_channels.c), escolhido
+// na compilação. Os canais usam o restante do perfil ativo (SF, BW...).
+// O padrão fica na portadora do perfil padrão; os planos de 8 canais tiram as
+// duas estações dela e devem ser escolhidos junto com os saltos nas duas.
+#define SX127X_PLAN_SINGLE      0   // Só a portadora do perfil padrão
+#define SX127X_PLAN_US915_SB2   1   // 903,9..905,3 MHz, 8 canais de 125 kHz
+#define SX127X_PLAN_AU915_SB2   2   // 916,8..918,2 MHz, 8 canais de 125 kHz
+
+#ifndef SX127X_CHANNEL_PLAN
+#define SX127X_CHANNEL_PLAN SX127X_PLAN_SINGLE
+#endif
+
+// Canal do plano com o Frf já calculado (REG_FRF_MSB..LSB)
+typedef struct {
+    uint32_t frequency_hz;
+    uint8_t frf[3];
+} sx127x_channel_t;
+
+// Descritor de um pacote recebido
+typedef struct {
+    uint8_t len;              // Bytes copiados para o buffer
+    int16_t rssi_dbm;         // Intensidade do pacote (dBm), já corrigida pelo SNR
+    int8_t snr_x4;            // SNR em passos de 0,25 dB
+    int32_t freq_error_hz;    // Desvio de frequência estimado (FEI) em relação ao transmissor
+    uint64_t timestamp_us;    // Instante da borda de RxDone no DIO0 (time_us_64)
+    bool crc_ok;              // CRC presente e válido
+} sx127x_packet_t;
+
+// Inicializa SPI, GPIOs e configura o módulo LoRa com sx127x_profile_default
 bool sx127x_init(void);
 
-// Envia uma mensagem via LoRa
+// Aplica um perfil de rádio em tempo de execução (deixa o rádio em standby).
+// O preâmbulo longo do sniff fica a cargo de quem monta o perfil.
+// Retorna false se algum campo estiver fora da faixa
+bool sx127x_configure(const sx127x_profile_t *profile);
+
+// Copia o perfil ativo
+void sx127x_get_profile(sx127x_profile_t *out);
+
+// Troca só a portadora para o canal 'ch' do plano (uma rajada de 3 bytes,
+// sem reaplicar o perfil). Deixa o rádio em standby: o chamador reinicia a
+// recepção ou transmite em seguida. Retorna false fora da faixa.
+bool sx127x_set_channel(uint8_t ch);
+
+// --- Cálculo de tempo no ar (sx127x_airtime.c, sem dependência de hardware) ---
+// Largura de banda (Hz) e duração de um símbolo (us) de um perfil
+uint32_t sx127x_bandwidth_hz(const sx127x_profile_t *profile);
+uint32_t sx127x_symbol_time_us(const sx127x_profile_t *profile);
+
+// --- Plano de canais (sx127x_channels.c, sem dependência de hardware) ---
+uint8_t sx127x_channel_count(void);
+
+// Canal 'ch' do plano ou NULL fora da faixa
+const sx127x_channel_t *sx127x_channel(uint8_t ch);
+
+// Sequência pseudoaleatória compartilhada: canal do quadro que começa na
+// sequência 'seq' do nó 'node_id'
+uint8_t sx127x_hop_channel(uint8_t node_id, uint16_t seq);
+
+// Indica se o perfil usa Low Data Rate Optimize (resolve SX127X_LDRO_AUTO)
+bool sx127x_ldro_enabled(const sx127x_profile_t *profile);
+
+// Tempo no ar (us) de um pacote com 'payload_len' bytes (AN1200.13 da Semtech)
+uint32_t sx127x_time_on_air_us(const sx127x_profile_t *profile, uint8_t payload_len);
+
+// Preâmbulo (símbolos) que um receptor acordando a cada 'period_ms' não perde
+// (nunca menor que o do perfil) e duração da janela de CAD do perfil
+uint16_t sx127x_sniff_preamble_len(const sx127x_profile_t *profile, uint32_t period_ms);
+uint32_t sx127x_cad_time_us(const sx127x_profile_t *profile);
+
+// Listen-before-talk de sx127x_send_message(): até SX127X_SEND_CAD_ATTEMPTS
+// detecções de atividade (CAD), com espera aleatória crescente a cada canal
+// ocupado, antes de transmitir mesmo assim (0 transmite direto)
+#ifndef SX127X_SEND_CAD_ATTEMPTS
+#define SX127X_SEND_CAD_ATTEMPTS 0
+#endif
+
+// Envia uma mensagem via LoRa (bloqueia até o TxDone)
 bool sx127x_send_message(const char *msg);
 
 // Recebe uma mensagem via LoRa (modo contínuo)
-// Retorna true se uma mensagem foi recebida
+// Retorna true se uma mensagem com CRC válido foi recebida
 bool sx127x_receive_message(char *buf, uint8_t max_len);
 
+// Escreve/lê 'len' bytes no FIFO a partir de FifoAddrPtr em uma única
+// transação SPI (endereço enviado uma vez, CS mantido baixo)
+void sx127x_write_fifo(const uint8_t *data, uint8_t len);
+void sx127x_read_fifo(uint8_t *data, uint8_t len);
+
+// Diagnóstico do barramento: total de transações SPI desde o boot
+// e o clock efetivamente configurado em sx127x_init()
+uint32_t sx127x_get_spi_transactions(void);
+uint32_t sx127x_get_spi_baud(void);
+
+// --- Operação orientada a interrupção (DIO0) ---
+// Registra o callback do DIO0 (NULL desabilita a interrupção)
+void sx127x_set_dio0_callback(sx127x_dio0_callback_t cb);
+
+// Carrega o FIFO e entra em TX; o fim é sinalizado por SX127X_IRQ_TX_DONE
+bool sx127x_start_tx(const uint8_t *data, uint8_t len);
+
+// Entra em recepção contínua; cada pacote sinaliza SX127X_IRQ_RX_DONE
+void sx127x_start_rx(void);
+
+// Sai de TX/RX e deixa o rádio em standby (FIFO e registradores preservados)
+void sx127x_standby(void);
+
+// Modo de menor consumo (~0,2 uA): registradores e perfil preservados, mas o
+// FIFO é perdido. start_tx/start_rx/start_cad acordam o rádio sozinhos.
+void sx127x_sleep(void);
+
+// Detecção de atividade no canal (~2 símbolos procurando um preâmbulo LoRa
+// no perfil ativo). O fim é sinalizado por SX127X_IRQ_CAD_DONE, junto com
+// SX127X_IRQ_CAD_DETECTED se o canal estava ocupado; o rádio volta a standby.
+void sx127x_start_cad(void);
+
+// CAD por polling (uso sem RTOS): true se o canal está ocupado
+bool sx127x_channel_busy(void);
+
+// Lê e limpa REG_IRQ_FLAGS (chamar em contexto de task, nunca na ISR)
+uint8_t sx127x_take_irq_flags(void);
+
+// Copia o último pacote recebido e preenche 'pkt' (pode ser NULL).
+// 'irq_flags' é o valor devolvido por sx127x_take_irq_flags(). Retorna false,
+// sem copiar o payload, se o CRC falhou ou se o perfil exige CRC e o pacote
+// chegou sem ele; RSSI/SNR são preenchidos mesmo nesse caso.
+bool sx127x_read_packet(uint8_t irq_flags, uint8_t *buf, uint8_t max_len, sx127x_packet_t *pkt);
+
 #endif
@@ -0,0 +1,61 @@
+// Tempo no ar de pacotes LoRa — apenas aritmética, compila também no host
+#include "sx127x.h"
+
+// Largura de banda em Hz para cada código de REG_MODEM_CONFIG1
+static const uint32_t bw_hz[] = {
+    7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000
+};
+
+uint32_t sx127x_bandwidth_hz(const sx127x_profile_t *p) {
+    return p->bw <= SX127X_BW_500K ? bw_hz[p->bw] : 0;
+}
+
+// Duração de um símbolo: Ts = 2^SF / BW
+uint32_t sx127x_symbol_time_us(const sx127x_profile_t *p) {
+    uint32_t bw = sx127x_bandwidth_hz(p);
+    if (bw == 0) return 0;
+    return (uint32_t)(((uint64_t)1000000u << p->sf) / bw);
+}
+
+// O datasheet exige LDRO quando o símbolo passa de 16 ms
+bool sx127x_ldro_enabled(const sx127x_profile_t *p) {
+    if (p->ldro == SX127X_LDRO_ON) return true;
+    if (p->ldro == SX127X_LDRO_OFF) return false;
+    return sx127x_symbol_time_us(p) > 16000;
+}
+
+// Tpacket = (Npreamble + 4.25) * Ts + Npayload * Ts, com
+// Npayload = 8 + max(ceil((8*PL - 4*SF + 28 + 16*CRC - 20*IH) / (4*(SF - 2*DE))) * (CR + 4), 0)
+uint32_t sx127x_time_on_air_us(const sx127x_profile_t *p, uint8_t payload_len) {
+    uint32_t bw = sx127x_bandwidth_hz(p);
+    if (bw == 0 || p->sf < 6 || p->sf > 12) return 0;
+
+    int32_t sf = p->sf;
+    int32_t de = sx127x_ldro_enabled(p) ? 1 : 0;
+    int32_t num = 8 * (int32_t)payload_len - 4 * sf + 28
+                + (p->crc_on ? 16 : 0) - (p->implicit_header ? 20 : 0);
+    int32_t den = 4 * (sf - 2 * de);
+    int32_t blocks = num > 0 ? (num + den - 1) / den : 0;
+    uint32_t payload_symbols = 8 + (uint32_t)(blocks * (p->cr + 4));
+
+    // Conta em quartos de símbolo para manter o 4.25 do preâmbulo exato
+    uint64_t quarter_symbols = (uint64_t)p->preamble_len * 4 + 17 + (uint64_t)payload_symbols * 4;
+    return (uint32_t)(((quarter_symbols * 1000000u) << sf) / (4u * (uint64_t)bw));
+}
+
+// Sniff: o preâmbulo precisa cobrir um período inteiro de sono do receptor
+// mais o CAD que o detecta e os símbolos de que o demodulador ainda precisa
+// para sincronizar depois de passar para RX
+uint16_t sx127x_sniff_preamble_len(const sx127x_profile_t *p, uint32_t period_ms) {
+    uint32_t ts = sx127x_symbol_time_us(p);
+    if (period_ms == 0 || ts == 0) return p->preamble_len;
+
+    uint32_t symbols = (uint32_t)(((uint64_t)period_ms * 1000u + ts - 1) / ts)
+                     + SX127X_SNIFF_CAD_SYMBOLS + SX127X_SNIFF_LOCK_SYMBOLS;
+    if (symbols < p->preamble_len) symbols = p->preamble_len;
+    return symbols > 0xFFFF ? 0xFFFF : (uint16_t)symbols;
+}
+
+uint32_t sx127x_cad_time_us(const sx127x_profile_t *p) {
+    return SX127X_SNIFF_CAD_SYMBOLS * sx127x_symbol_time_us(p);
+}
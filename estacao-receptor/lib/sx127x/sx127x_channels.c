@@ -0,0 +1,49 @@
+// Plano de canais e sequência de saltos — apenas tabelas e aritmética,
+// compila também no host
+#include <stddef.h>
+#include "sx127x.h"
+
+// Frf = Freq × 2^19 / 32 MHz, calculado em tempo de compilação e guardado
+// já na ordem de REG_FRF_MSB..LSB
+#define SX127X_FRF(hz) (((uint64_t)(hz) << 19) / 32000000u)
+#define CHANNEL(hz) { (hz), { (uint8_t)(SX127X_FRF(hz) >> 16), \
+                              (uint8_t)(SX127X_FRF(hz) >> 8),  \
+                              (uint8_t)SX127X_FRF(hz) } }
+
+static const sx127x_channel_t channels[] = {
+#if SX127X_CHANNEL_PLAN == SX127X_PLAN_US915_SB2
+    // US915, sub-banda 2: canais 8..15 de 125 kHz, 903,9 MHz + 200 kHz × n
+    CHANNEL(903900000), CHANNEL(904100000), CHANNEL(904300000), CHANNEL(904500000),
+    CHANNEL(904700000), CHANNEL(904900000), CHANNEL(905100000), CHANNEL(905300000),
+#elif SX127X_CHANNEL_PLAN == SX127X_PLAN_AU915_SB2
+    // AU915 (faixa de 915-928 MHz usada no Brasil), sub-banda 2: canais
+    // 8..15 de 125 kHz, 916,8 MHz + 200 kHz × n
+    CHANNEL(916800000), CHANNEL(917000000), CHANNEL(917200000), CHANNEL(917400000),
+    CHANNEL(917600000), CHANNEL(917800000), CHANNEL(918000000), CHANNEL(918200000),
+#else
+    // Portadora única do perfil padrão
+    CHANNEL(915000000),
+#endif
+};
+
+#define CHANNEL_COUNT (sizeof(channels) / sizeof(channels[0]))
+
+uint8_t sx127x_channel_count(void) {
+    return (uint8_t)CHANNEL_COUNT;
+}
+
+const sx127x_channel_t *sx127x_channel(uint8_t ch) {
+    return ch < CHANNEL_COUNT ? &channels[ch] : NULL;
+}
+
+// Mistura de 32 bits (finalizador do MurmurHash3): sequências de nós
+// diferentes e de sequências vizinhas ficam descorrelacionadas
+uint8_t sx127x_hop_channel(uint8_t node_id, uint16_t seq) {
+    uint32_t h = ((uint32_t)node_id << 16 | seq) ^ 0x5BD1E995u;
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return (uint8_t)(h % CHANNEL_COUNT);
+}
@@ -10,50 +10,721 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "sx127x.h"
+#include "telemetry.h"
+#include "link_stats.h"
+#include "rx_ring.h"
+#include "adr.h"
+#include "node_table.h"
+#include "snapshot.h"
 
-// Variáveis globais publicadas para outras tasks (display, etc.)
-volatile float temp_aht = 0.0f;
-volatile float umid_aht = 0.0f;
-volatile float pressao_bmp = 0.0f;
+// Quadros recebidos aguardando decodificação (potência de 2)
+#ifndef LORA_RX_RING_SLOTS
+#define LORA_RX_RING_SLOTS 8
+#endif
 
-// Buffer de recepção
-#define RX_BUFFER_SIZE 96
+// Cada slot comporta o maior pacote LoRa (FIFO inteiro do SX1276)
+#define LORA_RX_FRAME_MAX 255
 
-void vTaskLoRaRX(void *pvParameters) {
+// Intervalo máximo sem interrupção antes de conferir as flags por polling (ms)
+#ifndef LORA_RX_WATCHDOG_MS
+#define LORA_RX_WATCHDOG_MS 1000
+#endif
+
+// Após comandar outro SF, o receptor passa a escutar nele; sem quadros por
+// 3 intervalos (no mínimo LORA_ADR_CONFIRM_MIN_MS) o nó não ouviu o comando
+// e o receptor volta ao perfil anterior
+#ifndef LORA_ADR_CONFIRM_MIN_MS
+#define LORA_ADR_CONFIRM_MIN_MS 10000
+#endif
+
+// Silêncio que leva o receptor ao perfil padrão, o mesmo ponto de encontro
+// para onde o nó volta quando seus pedidos de ADR ficam sem resposta
+// (LORA_ADR_RENDEZVOUS_FRAMES intervalos, no mínimo LORA_ADR_RENDEZVOUS_MIN_MS)
+#define LORA_ADR_RENDEZVOUS_FRAMES 48
+#ifndef LORA_ADR_RENDEZVOUS_MIN_MS
+#define LORA_ADR_RENDEZVOUS_MIN_MS 60000
+#endif
+
+// Beacon de sincronismo TDMA: a cada LORA_TDMA_PERIOD_MS o receptor anuncia
+// o relógio e um slot de LORA_TDMA_SLOT_MS para cada nó da tabela (na ordem
+// da tabela, enquanto couber no período). Nós sem slot usam acesso aleatório
+// e ganham um no beacon seguinte ao primeiro quadro. Exige RADIO_TDMA nos nós.
+// O slot precisa comportar uplink + resposta + margens no SF em uso.
+#ifndef LORA_TDMA
+#define LORA_TDMA 0
+#endif
+#ifndef LORA_TDMA_PERIOD_MS
+#define LORA_TDMA_PERIOD_MS 10000
+#endif
+#ifndef LORA_TDMA_SLOT_MS
+#define LORA_TDMA_SLOT_MS 300
+#endif
+#ifndef LORA_TDMA_OFFSET_MS
+#define LORA_TDMA_OFFSET_MS 100     // Tempo para o nó tratar o beacon antes do slot 0
+#endif
+
+// Saltos de frequência: os nós trocam de canal a cada quadro seguindo
+// sx127x_hop_channel(nó, sequência). O SX1276 escuta um canal por vez, então
+// o receptor prevê o próximo quadro de cada nó (último quadro + intervalo
+// médio, com margem de 2× o jitter + LORA_HOP_GUARD_MS) e fica no canal do
+// que vence primeiro. Nós sem previsão (novos ou sem quadros por
+// LORA_HOP_MAX_MISSES intervalos) só são achados quando caem no canal em que
+// ele está; sem nenhum nó previsto, o receptor varre os canais trocando a
+// cada LORA_HOP_SCAN_MS. Exige RADIO_HOPPING nos nós e um plano de vários
+// canais em SX127X_CHANNEL_PLAN.
+#ifndef LORA_HOPPING
+#define LORA_HOPPING 0
+#endif
+#define LORA_HOP_GUARD_MS   100
+#define LORA_HOP_MAX_MISSES 8
+#ifndef LORA_HOP_SCAN_MS
+#define LORA_HOP_SCAN_MS 30000
+#endif
+
+// Recepção por amostragem para receptores/repetidores a bateria: em vez de
+// RX contínuo, o rádio dorme e acorda a cada SX127X_SNIFF_PERIOD_MS para um
+// CAD; só com preâmbulo detectado passa para RX até o RxDone. Os nós usam o
+// preâmbulo longo derivado do mesmo período (sx127x.h), então nenhum quadro
+// cai inteiro dentro do sono. Padrão: ligado quando o período é definido.
+#ifndef LORA_SNIFF
+#define LORA_SNIFF (SX127X_SNIFF_PERIOD_MS > 0)
+#endif
+#if LORA_SNIFF && SX127X_SNIFF_PERIOD_MS == 0
+#error "LORA_SNIFF exige SX127X_SNIFF_PERIOD_MS > 0 (nas duas estações)"
+#endif
+
+typedef struct {
+    uint32_t windows;         // CADs feitos
+    uint32_t detections;      // CADs com preâmbulo detectado
+    uint32_t false_wakeups;   // Detecções sem RxDone (ruído ou pacote de outra rede)
+    uint64_t awake_us;        // Tempo com o rádio fora do sono nas janelas
+    uint64_t start_us;
+} lora_sniff_stats_t;
+
+// Quadro copiado do FIFO junto com RSSI/SNR/FEI e timestamp
+typedef struct {
+    sx127x_packet_t info;
+    uint8_t data[LORA_RX_FRAME_MAX];
+} lora_rx_frame_t;
+
+// Fila SPSC: vTaskLoRaIRQ produz, vTaskLoRaRX consome
+static lora_rx_frame_t lora_rx_slots[LORA_RX_RING_SLOTS];
+static rx_ring_t lora_rx_ring;
+
+// Task dona do rádio (acordada pelo DIO0) e task que decodifica os quadros
+static TaskHandle_t lora_irq_task = NULL;
+static TaskHandle_t lora_rx_task = NULL;
+
+// Resposta aguardando a task do rádio (escrita por vTaskLoRaRX): confirmação,
+// comando ADR ou os dois no mesmo quadro
+static struct {
+    bool pending;
+    bool ack;
+    bool adr;
+    uint8_t node_id;
+    telemetry_adr_t cmd;
+} lora_downlink;
+
+// Estado de cada estação de campo: última leitura, janela de sequências,
+// estatísticas do enlace e ADR. Escrito em seções críticas curtas pela
+// vTaskLoRaRX (e pela task do rádio ao trocar de perfil); lido sempre por cópia.
+static node_table_t lora_nodes;          // Zerada = vazia
+
+// Leitura decodificada mais recente de qualquer nó, publicada só pela
+// vTaskLoRaRX e copiada sem trava pelo display e console
+static snapshot_t lora_rx_latest;        // Zerado = nada publicado
+
+// SF em que o receptor escuta (mantido pela task do rádio). Com mais de um
+// nó o ADR só ajusta potência: o SX1276 demodula um único SF por vez.
+static volatile uint8_t lora_rx_sf;
+
+// Troca de perfil em andamento
+static sx127x_profile_t lora_prev_profile;
+static uint8_t lora_switch_node;          // Nó que recebeu o comando de SF
+static uint32_t lora_switch_ms = 0;       // Instante da troca ainda não confirmada (0 = nenhuma)
+static uint32_t lora_last_rx_ms = 0;
+
+// RSSI/SNR/FEI do último pacote aceito e contagem de rejeições por CRC
+static sx127x_packet_t lora_last_packet;
+static uint32_t lora_crc_errors = 0;
+
+// Próximo beacon (ms desde o boot) e beacons enviados
+static uint32_t lora_beacon_due_ms = 0;
+static uint32_t lora_beacons = 0;
+
+// Próxima janela do sniff e estatísticas
+static uint32_t lora_sniff_due_ms = 0;
+static lora_sniff_stats_t lora_sniff;
+
+// Canal da varredura e instante da última troca
+static uint8_t lora_hop_scan = 0;
+static uint32_t lora_hop_scan_ms = 0;
+
+// Cópia do próximo nó da tabela a partir do slot 'from' (para display e
+// console USB). Retorna o slot copiado ou -1 no fim da tabela.
+int lora_rx_get_node(int from, node_entry_t *out) {
+    taskENTER_CRITICAL();
+    int i = node_table_next(&lora_nodes, from);
+    if (i >= 0) *out = lora_nodes.entries[i];
+    taskEXIT_CRITICAL();
+    return i;
+}
+
+// Cópia da leitura mais recente (false se nenhuma chegou)
+bool lora_rx_get_latest(snapshot_record_t *out) {
+    return snapshot_read(&lora_rx_latest, out);
+}
+
+// Quantidade de nós já ouvidos
+uint8_t lora_rx_node_count(void) {
+    return lora_nodes.count;
+}
+
+// Intervalo médio entre quadros de um nó (0 se desconhecido)
+static uint32_t lora_rx_node_interval(uint8_t node_id) {
+    taskENTER_CRITICAL();
+    node_entry_t *e = node_table_find(&lora_nodes, node_id);
+    uint32_t interval = e ? link_stats_interval_ms(&e->link) : 0;
+    taskEXIT_CRITICAL();
+    return interval;
+}
+
+// Ocupação máxima da fila de recepção e quadros perdidos com ela cheia
+void lora_rx_get_ring_stats(uint32_t *high_water, uint32_t *dropped) {
+    *high_water = lora_rx_ring.high_water;
+    *dropped = lora_rx_ring.dropped;
+}
+
+// Cópia das estatísticas do sniff
+void lora_rx_get_sniff_stats(lora_sniff_stats_t *out) {
+    taskENTER_CRITICAL();
+    *out = lora_sniff;
+    taskEXIT_CRITICAL();
+}
+
+// Beacons de sincronismo TDMA já enviados
+uint32_t lora_rx_get_beacons(void) {
+    return lora_beacons;
+}
+
+// Qualidade do último pacote recebido; retorna o total de pacotes rejeitados por CRC
+uint32_t lora_rx_get_last_packet(sx127x_packet_t *out) {
+    taskENTER_CRITICAL();
+    *out = lora_last_packet;
+    uint32_t crc_errors = lora_crc_errors;
+    taskEXIT_CRITICAL();
+    return crc_errors;
+}
+
+static void lora_rx_dio0_isr(void) {
+    BaseType_t woken = pdFALSE;
+    if (lora_irq_task) vTaskNotifyGiveFromISR(lora_irq_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+// Agenda a resposta ao nó: confirmação quando ele pede (mesmo para
+// duplicatas, cujo ACK anterior se perdeu) e comando ADR quando os parâmetros
+// mudam ou ele pede resposta
+static void lora_rx_reply(const telemetry_adr_t *cmd, uint8_t flags, bool changed) {
+    bool adr = changed || (flags & TELEMETRY_FLAG_ADR_ACK_REQ);
+    bool ack = (flags & TELEMETRY_FLAG_ACK_REQ) != 0;
+    if (!adr && !ack) return;
+
+    taskENTER_CRITICAL();
+    // Um comando ainda não enviado a outro nó é substituído (ele pedirá de novo)
+    if (lora_downlink.pending && lora_downlink.node_id != cmd->node_id) lora_downlink.adr = false;
+    lora_downlink.pending = true;
+    lora_downlink.node_id = cmd->node_id;
+    lora_downlink.ack = ack;
+    lora_downlink.adr = lora_downlink.adr || adr;   // Não perde um comando ainda não enviado
+    lora_downlink.cmd = *cmd;
+    taskEXIT_CRITICAL();
+    if (adr) {
+        printf("[LoRaRX] ADR nó %u: SF%u, %d dBm%s\n", cmd->node_id, cmd->sf, cmd->tx_power_dbm,
+               changed ? "" : " (resposta ao pedido)");
+    }
+    if (lora_irq_task) xTaskNotifyGive(lora_irq_task);
+}
+
+// Atualiza a entrada do nó com um quadro: sequências, última amostra,
+// RSSI/SNR e ADR, e publica a amostra em lora_rx_latest. Retorna false se
+// for duplicado (não é publicado).
+static bool lora_rx_node_frame(uint8_t node_id, uint16_t seq_first, uint8_t count, uint8_t flags,
+                               const telemetry_sample_t *last, const sx127x_packet_t *pkt) {
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    uint16_t seq_last = (uint16_t)(seq_first + count - 1);
+
+    taskENTER_CRITICAL();
+    bool created;
+    node_entry_t *e = node_table_insert(&lora_nodes, node_id, now, &created);
+    if (!e) {
+        taskEXIT_CRITICAL();
+        printf("[LoRaRX] Tabela de nós cheia, nó %u ignorado.\n", node_id);
+        return false;
+    }
+    if (created) adr_init(&e->adr, lora_rx_sf, sx127x_profile_default.tx_power_dbm);
+
+    link_seq_result_t res = link_stats_update(&e->link, seq_first, count, now);
+    bool fresh = res != LINK_SEQ_DUPLICATE;
+    bool changed = false;
+    if (fresh) {
+        e->last_seen_ms = now;
+        e->last_seq = seq_last;
+        e->flags = flags;
+        e->last_count = count;
+        if (flags & TELEMETRY_FLAG_AHT_OK) {
+            e->temp_cdeg = last->temp_cdeg;
+            e->humidity_cpct = last->humidity_cpct;
+        }
+        if (flags & TELEMETRY_FLAG_BMP_OK) e->pressure_pa = last->pressure_pa;
+        e->rssi_dbm = pkt->rssi_dbm;
+        e->snr_x4 = pkt->snr_x4;
+
+        uint8_t sf = e->adr.sf;
+        int8_t power = e->adr.tx_power_dbm;
+        adr_update(&e->adr, pkt->snr_x4);
+        if (lora_nodes.count > 1) e->adr.sf = lora_rx_sf;
+        changed = e->adr.sf != sf || e->adr.tx_power_dbm != power;
+    }
+    telemetry_adr_t cmd = {
+        .node_id = node_id,
+        .seq = seq_last,
+        .sf = e->adr.sf,
+        .tx_power_dbm = e->adr.tx_power_dbm,
+    };
+    taskEXIT_CRITICAL();
+
+    if (created) printf("[LoRaRX] Novo nó %u (%u na tabela).\n", node_id, lora_nodes.count);
+    if (res == LINK_SEQ_DUPLICATE) printf("[LoRaRX] Nó %u: quadro duplicado (seq %u), ignorado.\n", node_id, seq_first);
+    if (res == LINK_SEQ_RESTART) printf("[LoRaRX] Nó %u reiniciou a sequência.\n", node_id);
+
+    lora_rx_reply(&cmd, flags, changed);
+    if (fresh) {
+        snapshot_record_t rec = {
+            .timestamp_ms = now,
+            .node_id = node_id,
+            .flags = flags & (TELEMETRY_FLAG_AHT_OK | TELEMETRY_FLAG_BMP_OK),
+            .frame_seq = seq_last,
+            .sample = *last,
+        };
+        snapshot_publish(&lora_rx_latest, &rec);
+    }
+    return fresh;
+}
+
+// Aplica um perfil com o preâmbulo longo do sniff (SX127X_SNIFF_PERIOD_MS),
+// recalculado para o SF/BW do perfil a partir do preâmbulo padrão
+static bool lora_rx_configure(const sx127x_profile_t *profile) {
+    sx127x_profile_t p = *profile;
+    p.preamble_len = sx127x_profile_default.preamble_len;
+    p.preamble_len = sx127x_sniff_preamble_len(&p, SX127X_SNIFF_PERIOD_MS);
+    return sx127x_configure(&p);
+}
+
+// Troca o perfil do receptor e reinicia o ADR dos nós no novo SF
+// ('tx_power_dbm' < 0 mantém a potência de cada nó)
+static void lora_rx_set_profile(const sx127x_profile_t *profile, int8_t tx_power_dbm) {
+    lora_rx_configure(profile);
+    lora_rx_sf = profile->sf;
+    taskENTER_CRITICAL();
+    for (int i = node_table_next(&lora_nodes, 0); i >= 0; i = node_table_next(&lora_nodes, i + 1)) {
+        adr_t *a = &lora_nodes.entries[i].adr;
+        adr_init(a, profile->sf, tx_power_dbm < 0 ? a->tx_power_dbm : tx_power_dbm);
+    }
+    taskEXIT_CRITICAL();
+}
+
+// Envia a resposta pendente dentro da janela de recepção do nó e, se o SF
+// mudou, passa a escutar no novo SF junto com ele
+static void lora_rx_send_downlink(void) {
+    taskENTER_CRITICAL();
+    bool pending = lora_downlink.pending;
+    bool ack = lora_downlink.ack;
+    bool adr = lora_downlink.adr;
+    uint8_t node_id = lora_downlink.node_id;
+    telemetry_adr_t cmd = lora_downlink.cmd;
+    lora_downlink.pending = lora_downlink.ack = lora_downlink.adr = false;
+    taskEXIT_CRITICAL();
+    if (!pending) return;
+
+    // O bitmap sai do estado mais recente do enlace: cobre também quadros
+    // recebidos depois do pedido
+    uint8_t data[TELEMETRY_DOWNLINK_MAX_LEN];
+    size_t len;
+    if (ack) {
+        taskENTER_CRITICAL();
+        node_entry_t *e = node_table_find(&lora_nodes, node_id);
+        uint16_t last_seq = e ? (uint16_t)(e->link.expected - 1) : cmd.seq;
+        uint32_t bitmap = e ? (uint32_t)e->link.recent : 0;
+        taskEXIT_CRITICAL();
+        telemetry_ack_t a = {
+            .node_id = node_id,
+            .last_seq = last_seq,
+            .bitmap = bitmap,
+            .has_adr = adr,
+            .sf = cmd.sf,
+            .tx_power_dbm = cmd.tx_power_dbm,
+        };
+        len = telemetry_encode_ack(&a, data, sizeof(data));
+    } else {
+        len = telemetry_encode_adr(&cmd, data, sizeof(data));
+    }
+
+    sx127x_profile_t profile;
+    sx127x_get_profile(&profile);
+    uint32_t timeout = sx127x_time_on_air_us(&profile, (uint8_t)len) / 1000 + 100;
+
+    ulTaskNotifyTake(pdTRUE, 0);
+    sx127x_start_tx(data, (uint8_t)len);
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout));
+    sx127x_take_irq_flags();
+
+    uint8_t sf = adr ? cmd.sf : profile.sf;
+    if (sf != profile.sf) {
+        lora_prev_profile = profile;
+        profile.sf = sf;
+        lora_rx_configure(&profile);
+        lora_rx_sf = sf;
+        lora_switch_node = node_id;
+        lora_switch_ms = to_ms_since_boot(get_absolute_time());
+        if (lora_switch_ms == 0) lora_switch_ms = 1;
+    }
+    sx127x_start_rx();
+}
+
+// Monta o mapa de slots com os nós da tabela que cabem no superquadro
+static void lora_rx_slot_map(telemetry_beacon_t *b, uint32_t beacon_airtime_ms) {
+    uint32_t room = LORA_TDMA_PERIOD_MS - LORA_TDMA_OFFSET_MS - beacon_airtime_ms;
+    uint32_t max = room / LORA_TDMA_SLOT_MS;
+    if (max > TELEMETRY_BEACON_MAX_SLOTS) max = TELEMETRY_BEACON_MAX_SLOTS;
+
+    b->slot_count = 0;
+    taskENTER_CRITICAL();
+    for (int i = node_table_next(&lora_nodes, 0); i >= 0 && b->slot_count < max;
+         i = node_table_next(&lora_nodes, i + 1)) {
+        b->slots[b->slot_count++] = lora_nodes.entries[i].node_id;
+    }
+    taskEXIT_CRITICAL();
+}
+
+// Envia o beacon quando vencer; o relógio anunciado é o do fim da
+// transmissão, o mesmo instante em que o DIO0 dos nós marca o RxDone.
+// Retorna quanto falta (ms) para o próximo.
+static uint32_t lora_rx_send_beacon(void) {
+    if (!LORA_TDMA) return UINT32_MAX;
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    int32_t wait = (int32_t)(lora_beacon_due_ms - now);
+    if (wait > 0) return (uint32_t)wait;
+
+    sx127x_profile_t profile;
+    sx127x_get_profile(&profile);
+    uint32_t max_airtime_us = sx127x_time_on_air_us(&profile, TELEMETRY_BEACON_MAX_LEN);
+    telemetry_beacon_t b = {
+        .period_ms = LORA_TDMA_PERIOD_MS,
+        .slot_ms = LORA_TDMA_SLOT_MS,
+        .offset_ms = LORA_TDMA_OFFSET_MS,
+    };
+    lora_rx_slot_map(&b, (max_airtime_us + 999) / 1000);
+
+    uint8_t data[TELEMETRY_BEACON_MAX_LEN];
+    uint8_t len = (uint8_t)(TELEMETRY_BEACON_HEADER_LEN + b.slot_count);
+    uint32_t airtime_us = sx127x_time_on_air_us(&profile, len);
+    b.gateway_ms = (uint32_t)((time_us_64() + airtime_us) / 1000);
+    telemetry_encode_beacon(&b, data, sizeof(data));
+
+    if (LORA_HOPPING) sx127x_set_channel(0);  // Canal fixo dos beacons
+    ulTaskNotifyTake(pdTRUE, 0);
+    sx127x_start_tx(data, len);
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(airtime_us / 1000 + 100));
+    sx127x_take_irq_flags();
+    sx127x_start_rx();
+    lora_beacons++;
+
+    // Período fixo a partir do primeiro beacon; se atrasou mais de um
+    // período (ex.: troca de perfil), recomeça a partir de agora
+    lora_beacon_due_ms += LORA_TDMA_PERIOD_MS;
+    if ((int32_t)(lora_beacon_due_ms - now) <= 0) lora_beacon_due_ms = now + LORA_TDMA_PERIOD_MS;
+    return lora_beacon_due_ms - now;
+}
+
+// Passa a escutar no canal 'ch' (não interrompe a recepção se já estiver nele)
+static void lora_rx_tune(uint8_t ch) {
+    sx127x_profile_t profile;
+    sx127x_get_profile(&profile);
+    if (profile.frequency_hz == sx127x_channel(ch)->frequency_hz) return;
+    sx127x_set_channel(ch);
+    sx127x_start_rx();
+}
+
+// Sintoniza o canal do próximo quadro previsto entre os nós acompanhados.
+// Retorna quanto falta (ms) para reavaliar.
+static uint32_t lora_rx_hop_poll(void) {
+    if (!LORA_HOPPING) return UINT32_MAX;
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    bool found = false;
+    uint32_t close_ms = 0;
+    uint8_t ch = 0;
+
+    taskENTER_CRITICAL();
+    for (int i = node_table_next(&lora_nodes, 0); i >= 0; i = node_table_next(&lora_nodes, i + 1)) {
+        const node_entry_t *e = &lora_nodes.entries[i];
+        uint32_t interval = link_stats_interval_ms(&e->link);
+        if (interval == 0) continue;
+        uint32_t tol = 2 * link_stats_jitter_ms(&e->link) + LORA_HOP_GUARD_MS;
+
+        // Primeiro quadro previsto cuja janela ainda não fechou; os que
+        // passaram sem recepção avançam a sequência (o nó seguiu saltando)
+        uint32_t since = now - e->last_seen_ms;
+        uint32_t k = since > tol ? (since - tol) / interval + 1 : 1;
+        if (k > LORA_HOP_MAX_MISSES) continue;
+
+        uint32_t close = e->last_seen_ms + k * interval + tol;
+        if (found && (int32_t)(close - close_ms) >= 0) continue;
+        uint8_t stride = e->last_count ? e->last_count : 1;
+        uint16_t seq = (uint16_t)(e->link.expected + (k - 1) * stride);
+        found = true;
+        close_ms = close;
+        ch = sx127x_hop_channel(e->node_id, seq);
+    }
+    taskEXIT_CRITICAL();
+
+    if (found) {
+        lora_rx_tune(ch);
+        return close_ms - now;
+    }
+
+    if (now - lora_hop_scan_ms >= LORA_HOP_SCAN_MS) {
+        lora_hop_scan = (uint8_t)((lora_hop_scan + 1) % sx127x_channel_count());
+        lora_hop_scan_ms = now;
+    }
+    lora_rx_tune(lora_hop_scan);
+    return LORA_HOP_SCAN_MS - (now - lora_hop_scan_ms);
+}
+
+// Desfaz trocas de SF não confirmadas e procura o nó no perfil padrão
+// depois de um silêncio longo
+static void lora_rx_check_sync(void) {
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    uint32_t interval = lora_rx_node_interval(lora_switch_node);
+
+    uint32_t confirm = 3 * interval;
+    if (confirm < LORA_ADR_CONFIRM_MIN_MS) confirm = LORA_ADR_CONFIRM_MIN_MS;
+    uint32_t rendezvous = LORA_ADR_RENDEZVOUS_FRAMES * interval;
+    if (rendezvous < LORA_ADR_RENDEZVOUS_MIN_MS) rendezvous = LORA_ADR_RENDEZVOUS_MIN_MS;
+
+    sx127x_profile_t profile;
+    sx127x_get_profile(&profile);
+    if (lora_switch_ms && now - lora_switch_ms >= confirm) {
+        printf("[LoRaRX] ADR: nada recebido em SF%u, voltando para SF%u.\n",
+               profile.sf, lora_prev_profile.sf);
+        lora_rx_set_profile(&lora_prev_profile, -1);
+        lora_switch_ms = 0;
+        lora_last_rx_ms = now;
+        sx127x_start_rx();
+    } else if (now - lora_last_rx_ms >= rendezvous && profile.sf != sx127x_profile_default.sf) {
+        printf("[LoRaRX] ADR: enlace perdido, voltando ao perfil padrão.\n");
+        lora_rx_set_profile(&sx127x_profile_default, sx127x_profile_default.tx_power_dbm);
+        lora_last_rx_ms = now;
+        sx127x_start_rx();
+    }
+}
+
+// Copia o pacote do FIFO para a fila antes que o próximo o sobrescreva
+static void lora_rx_capture(uint8_t flags) {
+    // Fila cheia: o quadro é perdido e contado em lora_rx_ring.dropped
+    int32_t slot = rx_ring_reserve(&lora_rx_ring);
+    if (slot < 0) return;
+
+    // CRC verificado pelo rádio: quadros corrompidos nem chegam ao decodificador
+    lora_rx_frame_t *f = &lora_rx_slots[slot];
+    if (!sx127x_read_packet(flags, f->data, sizeof(f->data), &f->info)) {
+        taskENTER_CRITICAL();
+        lora_crc_errors++;
+        taskEXIT_CRITICAL();
+        return;
+    }
+    rx_ring_commit(&lora_rx_ring);
+    if (lora_rx_task) xTaskNotifyGive(lora_rx_task);
+
+    // Qualquer quadro válido no SF novo confirma a troca
+    lora_last_rx_ms = to_ms_since_boot(get_absolute_time());
+    lora_switch_ms = 0;
+}
+
+// Espera uma borda do DIO0 por até 'timeout_ms'. Notificações de outras
+// tasks não encerram a espera: só as flags do rádio contam.
+static uint8_t lora_rx_wait_irq(uint32_t timeout_ms) {
+    uint32_t start = to_ms_since_boot(get_absolute_time());
+    uint8_t flags;
+    while ((flags = sx127x_take_irq_flags()) == 0) {
+        int32_t left = (int32_t)(timeout_ms - (to_ms_since_boot(get_absolute_time()) - start));
+        if (left <= 0) break;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(left));
+    }
+    return flags;
+}
+
+// Uma janela do sniff: CAD e, com preâmbulo detectado, RX até o RxDone.
+// Termina em standby (o FIFO se perde no sono) e devolve as flags do RX.
+static uint8_t lora_rx_sniff_window(void) {
+    sx127x_profile_t profile;
+    sx127x_get_profile(&profile);
+    uint64_t t0 = time_us_64();
+
+    ulTaskNotifyTake(pdTRUE, 0);
+    sx127x_start_cad();
+    uint8_t flags = lora_rx_wait_irq(sx127x_cad_time_us(&profile) / 1000 + 2);
+    bool detected = (flags & SX127X_IRQ_CAD_DETECTED) != 0;
+    bool received = false;
+    flags = 0;
+    if (detected) {
+        // O restante do preâmbulo mais o maior pacote
+        sx127x_start_rx();
+        flags = lora_rx_wait_irq(sx127x_time_on_air_us(&profile, LORA_RX_FRAME_MAX) / 1000 + 10);
+        received = (flags & SX127X_IRQ_RX_DONE) != 0;
+    }
+    sx127x_standby();
+
+    taskENTER_CRITICAL();
+    lora_sniff.windows++;
+    if (detected) lora_sniff.detections++;
+    if (detected && !received) lora_sniff.false_wakeups++;
+    lora_sniff.awake_us += time_us_64() - t0;
+    taskEXIT_CRITICAL();
+    return flags;
+}
+
+// Tratamento do RxDone: arma a recepção contínua uma única vez e, a cada
+// borda do DIO0, copia o pacote do FIFO para a fila antes que o próximo
+// o sobrescreva. Roda com prioridade alta e não decodifica; também é a única
+// task que transmite (ACK e comandos ADR) e troca o perfil do rádio.
+void vTaskLoRaIRQ(void *pvParameters) {
     (void)pvParameters;
 
     printf("[LoRaRX] Iniciando receptor...\n");
-    if (!sx127x_init()) {
+    if (!sx127x_init() || !lora_rx_configure(&sx127x_profile_default)) {
         printf("[LoRaRX] ERRO: SX1276 não detectado.\n");
         vTaskDelete(NULL);
     }
 
+    rx_ring_init(&lora_rx_ring, LORA_RX_RING_SLOTS);
+    lora_rx_sf = sx127x_profile_default.sf;
+    lora_last_rx_ms = to_ms_since_boot(get_absolute_time());
+    lora_irq_task = xTaskGetCurrentTaskHandle();
+    sx127x_set_dio0_callback(lora_rx_dio0_isr);
+    sx127x_start_rx();
+    lora_beacon_due_ms = to_ms_since_boot(get_absolute_time()) + LORA_TDMA_PERIOD_MS;
+    lora_sniff_due_ms = to_ms_since_boot(get_absolute_time());
+    lora_sniff.start_us = time_us_64();
+    if (LORA_SNIFF) {
+        sx127x_profile_t profile;
+        sx127x_get_profile(&profile);
+        printf("[LoRaRX] Sniff a cada %u ms: CAD de %lu us, preâmbulo de %u símbolos.\n",
+               SX127X_SNIFF_PERIOD_MS, (unsigned long)sx127x_cad_time_us(&profile), profile.preamble_len);
+    }
     printf("[LoRaRX] Pronto. Aguardando mensagens...\n");
-    char buffer[RX_BUFFER_SIZE];
 
+    uint32_t beacon_wait = UINT32_MAX;
+    uint32_t hop_wait = UINT32_MAX;
     for (;;) {
-        if (sx127x_receive_message(buffer, sizeof(buffer))) {
-            printf("[LoRaRX] Recebido: %s\n", buffer);
+        // Bloqueia sem consumir CPU até o DIO0 sinalizar RxDone (ou até o
+        // beacon ou a próxima troca de canal)
+        uint32_t block = beacon_wait < LORA_RX_WATCHDOG_MS ? beacon_wait : LORA_RX_WATCHDOG_MS;
+        if (hop_wait < block) block = hop_wait;
+        uint8_t flags = 0;
+        if (!LORA_SNIFF) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(block));
+            flags = sx127x_take_irq_flags();
+        } else {
+            // Dorme até a próxima janela (ou até uma resposta/beacon pendente)
+            uint32_t now = to_ms_since_boot(get_absolute_time());
+            int32_t to_window = (int32_t)(lora_sniff_due_ms - now);
+            if (to_window > 0) {
+                if ((uint32_t)to_window < block) block = (uint32_t)to_window;
+                sx127x_sleep();
+                ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(block));
+            } else {
+                flags = lora_rx_sniff_window();
+                lora_sniff_due_ms += SX127X_SNIFF_PERIOD_MS;
+                if ((int32_t)(lora_sniff_due_ms - now) <= 0) lora_sniff_due_ms = now + SX127X_SNIFF_PERIOD_MS;
+            }
+        }
+        if (flags & SX127X_IRQ_RX_DONE) lora_rx_capture(flags);
 
-            // Espera formato CSV: TS,temp,umid,press,seq
-            char *token = strtok(buffer, ",");
-            if (token && strcmp(token, "TS") == 0) {
-                token = strtok(NULL, ",");
-                if (token) temp_aht = atof(token);
+        // A resposta vai primeiro: o nó só escuta logo após o uplink
+        lora_rx_send_downlink();
+        beacon_wait = lora_rx_send_beacon();
+        lora_rx_check_sync();
+        hop_wait = lora_rx_hop_poll();
+    }
+}
 
-                token = strtok(NULL, ",");
-                if (token) umid_aht = atof(token);
+// Decodifica os quadros na ordem de chegada e publica os valores
+static void lora_rx_handle(const lora_rx_frame_t *f) {
+    const uint8_t *buffer = f->data;
+    const sx127x_packet_t pkt = f->info;
+    uint8_t len = pkt.len;
 
-                token = strtok(NULL, ",");
-                if (token) pressao_bmp = atof(token);
+    taskENTER_CRITICAL();
+    lora_last_packet = pkt;
+    taskEXIT_CRITICAL();
 
-                // token = strtok(NULL, ","); // seq (opcional)
-            } else {
-                printf("[LoRaRX] Formato inválido.\n");
-            }
+    // Quadros binários em ponto fixo (ver telemetry.h)
+    telemetry_reading_t r;
+    static telemetry_batch_t batch;
+    switch (telemetry_frame_type(buffer, len)) {
+    case TELEMETRY_TYPE_READING:
+        if (!telemetry_decode(buffer, len, &r)) break;
+        {
+            telemetry_sample_t sample = { r.temp_cdeg, r.humidity_cpct, r.pressure_pa };
+            if (!lora_rx_node_frame(r.node_id, r.seq, 1, r.flags, &sample, &pkt)) return;
         }
+        printf("[LoRaRX] Nó %u seq %u: %d cC, %u c%%, %lu Pa (RSSI %d dBm, SNR %.2f dB)\n",
+               r.node_id, r.seq, r.temp_cdeg, r.humidity_cpct, (unsigned long)r.pressure_pa,
+               pkt.rssi_dbm, pkt.snr_x4 / 4.0f);
+        return;
+
+    case TELEMETRY_TYPE_BATCH:
+        if (!telemetry_decode_batch(buffer, len, &batch)) break;
+        {
+            // A tabela guarda a amostra mais recente do lote
+            const telemetry_sample_t *last = &batch.samples[batch.count - 1];
+            if (!lora_rx_node_frame(batch.node_id, batch.seq_first, batch.count, batch.flags,
+                                    last, &pkt)) return;
+            printf("[LoRaRX] Nó %u lote seq %u..%u (%u amostras, %u bytes): %d cC, %u c%%, %lu Pa\n",
+                   batch.node_id, batch.seq_first, (uint16_t)(batch.seq_first + batch.count - 1),
+                   batch.count, len, last->temp_cdeg, last->humidity_cpct,
+                   (unsigned long)last->pressure_pa);
+        }
+        return;
+
+    default:
+        break;
+    }
+    printf("[LoRaRX] Formato inválido (%u bytes, cabeçalho 0x%02X).\n",
+           len, len ? buffer[0] : 0);
+}
+
+// Consome a fila de recepção; acordada a cada quadro publicado por vTaskLoRaIRQ
+void vTaskLoRaRX(void *pvParameters) {
+    (void)pvParameters;
 
-        vTaskDelay(pdMS_TO_TICKS(100)); // pequena folga
+    lora_rx_task = xTaskGetCurrentTaskHandle();
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LORA_RX_WATCHDOG_MS));
+
+        int32_t slot;
+        bool handled = false;
+        while ((slot = rx_ring_peek(&lora_rx_ring)) >= 0) {
+            lora_rx_handle(&lora_rx_slots[slot]);
+            rx_ring_release(&lora_rx_ring);
+            handled = true;
+        }
+        // A previsão do próximo canal mudou com os quadros novos
+        if (LORA_HOPPING && handled && lora_irq_task) xTaskNotifyGive(lora_irq_task);
     }
 }
 
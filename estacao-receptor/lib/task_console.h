@@ -0,0 +1,108 @@
+// task_console.h — consultas pelo USB serial (stdio)
+#ifndef TASK_CONSOLE_H
+#define TASK_CONSOLE_H
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "node_table.h"
+#include "sx127x.h"
+#include "snapshot.h"
+
+// Intervalo de verificação do teclado (ms)
+#define CONSOLE_POLL_MS 200
+
+int lora_rx_get_node(int from, node_entry_t *out);
+uint8_t lora_rx_node_count(void);
+uint32_t lora_rx_get_last_packet(sx127x_packet_t *out);
+void lora_rx_get_ring_stats(uint32_t *high_water, uint32_t *dropped);
+uint32_t lora_rx_get_beacons(void);
+void lora_rx_get_sniff_stats(lora_sniff_stats_t *out);
+bool lora_rx_get_latest(snapshot_record_t *out);
+
+static void console_print_link_stats(void) {
+    node_entry_t n;
+    printf("[Enlace] %u nós\n", lora_rx_node_count());
+    for (int i = lora_rx_get_node(0, &n); i >= 0; i = lora_rx_get_node(i + 1, &n)) {
+        const link_stats_t *ls = &n.link;
+        uint16_t per = link_stats_per_permille(ls);
+        printf("[Nó %u] recebidos %lu | perdidos %lu | duplicados %lu | fora de ordem %lu | reinícios %lu\n",
+               n.node_id, (unsigned long)ls->received, (unsigned long)ls->lost,
+               (unsigned long)ls->duplicates, (unsigned long)ls->out_of_order, (unsigned long)ls->restarts);
+        printf("[Nó %u] PER(64) %u.%u%% | intervalo %lu ms | jitter %lu ms | próxima seq %u | "
+               "RSSI %d dBm | SNR %.2f dB | SF%u %d dBm\n",
+               n.node_id, per / 10, per % 10, (unsigned long)link_stats_interval_ms(ls),
+               (unsigned long)link_stats_jitter_ms(ls), ls->expected,
+               n.rssi_dbm, n.snr_x4 / 4.0f, n.adr.sf, n.adr.tx_power_dbm);
+    }
+
+    sx127x_packet_t pkt;
+    uint32_t crc_errors = lora_rx_get_last_packet(&pkt);
+    printf("[Enlace] último pacote: RSSI %d dBm | SNR %.2f dB | FEI %ld Hz | erros de CRC %lu\n",
+           pkt.rssi_dbm, pkt.snr_x4 / 4.0f,
+           (long)pkt.freq_error_hz, (unsigned long)crc_errors);
+
+    uint32_t high_water, dropped;
+    lora_rx_get_ring_stats(&high_water, &dropped);
+    printf("[Enlace] fila RX: ocupação máxima %lu | descartados por fila cheia %lu\n",
+           (unsigned long)high_water, (unsigned long)dropped);
+    if (LORA_SNIFF) {
+        lora_sniff_stats_t sn;
+        lora_rx_get_sniff_stats(&sn);
+        uint64_t elapsed = time_us_64() - sn.start_us;
+        uint32_t awake_permille = elapsed ? (uint32_t)(sn.awake_us * 1000 / elapsed) : 0;
+        printf("[Enlace] sniff: janelas %lu | detecções %lu | falsos despertares %lu | rádio acordado %lu.%lu%%\n",
+               (unsigned long)sn.windows, (unsigned long)sn.detections, (unsigned long)sn.false_wakeups,
+               (unsigned long)(awake_permille / 10), (unsigned long)(awake_permille % 10));
+    }
+    if (LORA_TDMA) printf("[Enlace] beacons TDMA enviados %lu\n", (unsigned long)lora_rx_get_beacons());
+
+    snapshot_record_t latest;
+    if (lora_rx_get_latest(&latest)) {
+        uint32_t age = to_ms_since_boot(get_absolute_time()) - latest.timestamp_ms;
+        printf("[Enlace] leitura mais recente (%lu publicadas): nó %u seq %u | %d cC | %u c%% | %lu Pa | há %lu ms\n",
+               (unsigned long)latest.seq, latest.node_id, latest.frame_seq, latest.sample.temp_cdeg,
+               latest.sample.humidity_cpct, (unsigned long)latest.sample.pressure_pa, (unsigned long)age);
+    }
+}
+
+// Exportação da tabela de nós em CSV (uma linha por nó)
+static void console_export_csv(void) {
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    node_entry_t n;
+    printf("no,seq,temp_c,umid_pct,pressao_kpa,rssi_dbm,snr_db,per_pct,recebidos,perdidos,idade_s\n");
+    for (int i = lora_rx_get_node(0, &n); i >= 0; i = lora_rx_get_node(i + 1, &n)) {
+        uint16_t per = link_stats_per_permille(&n.link);
+        printf("%u,%u,%.2f,%.2f,%.3f,%d,%.2f,%u.%u,%lu,%lu,%lu\n",
+               n.node_id, n.last_seq, n.temp_cdeg / 100.0f, n.humidity_cpct / 100.0f,
+               n.pressure_pa / 1000.0f, n.rssi_dbm, n.snr_x4 / 4.0f, per / 10, per % 10,
+               (unsigned long)n.link.received, (unsigned long)n.link.lost,
+               (unsigned long)((now - n.last_seen_ms) / 1000));
+    }
+}
+
+void vTaskConsole(void *pvParameters) {
+    (void)pvParameters;
+
+    for (;;) {
+        int c = getchar_timeout_us(0);
+        switch (c) {
+        case 's':
+            console_print_link_stats();
+            break;
+        case 'e':
+            console_export_csv();
+            break;
+        case 'h':
+        case '?':
+            printf("Comandos: s = estatísticas do enlace, e = exporta a tabela de nós (CSV)\n");
+            break;
+        default:
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(CONSOLE_POLL_MS));
+    }
+}
+
+#endif
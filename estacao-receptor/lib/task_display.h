@@ -5,12 +5,16 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "hardware/i2c.h"
+#include "i2c_bus/i2c_bus.h"
 #include "ssd1306/ssd1306.h"
+#include "node_table.h"
 
-// Variáveis globais dos sensores
-extern volatile float temp_aht;
-extern volatile float umid_aht;
-extern volatile float pressao_bmp;
+// Tabela de nós mantida pela task_LoRa.h
+int lora_rx_get_node(int from, node_entry_t *out);
+uint8_t lora_rx_node_count(void);
+
+// Tempo que cada nó fica na tela antes de passar ao próximo
+#define DISPLAY_PAGE_MS 3000
 
 // I2C do display
 #define I2C_PORT_DISP i2c1
@@ -19,26 +23,49 @@ extern volatile float pressao_bmp;
 #define DISPLAY_ADDR 0x3C
 
 void vTaskDisplay(void *pvParameters) {
-    // Inicializa o barramento I2C1 para o display
-    i2c_init(I2C_PORT_DISP, 400 * 1000);
-    gpio_set_function(SDA_DISP, GPIO_FUNC_I2C);
-    gpio_set_function(SCL_DISP, GPIO_FUNC_I2C);
-    gpio_pull_up(SDA_DISP);
-    gpio_pull_up(SCL_DISP);
+    // Inicializa o barramento I2C1 para o display (framebuffer enviado por DMA)
+    i2c_bus_init(I2C_PORT_DISP, 400 * 1000, SDA_DISP, SCL_DISP);
 
     // Inicializa o display SSD1306
     ssd1306_t ssd;
     ssd1306_init(&ssd, WIDTH, HEIGHT, false, DISPLAY_ADDR, I2C_PORT_DISP);
     ssd1306_config(&ssd);
 
-    char str_tempAHT[8], str_umi[8], str_pressao[8];
+    char str_tempAHT[8], str_umi[8], str_pressao[12], str_per[12], str_no[16];
+    node_entry_t node;
+    int slot = -1;            // Nó em exibição
+    uint8_t page = 0;         // Posição dele entre os nós conhecidos
+    TickType_t page_start = 0;
     bool cor = true;
 
     while (1) {
-        // Converte dados para string
-        sprintf(str_tempAHT, "%.1fC", temp_aht);
-        sprintf(str_umi, "%.1f%%", umid_aht);
-        sprintf(str_pressao, "%.1fKPa", pressao_bmp);
+        // Um nó por página, em rodízio pela tabela
+        if (slot < 0 || (xTaskGetTickCount() - page_start) >= pdMS_TO_TICKS(DISPLAY_PAGE_MS)) {
+            slot = lora_rx_get_node(slot + 1, &node);
+            page++;
+            if (slot < 0) {
+                slot = lora_rx_get_node(0, &node);
+                page = 1;
+            }
+            page_start = xTaskGetTickCount();
+        } else {
+            lora_rx_get_node(slot, &node);        // Atualiza o mesmo nó
+        }
+
+        if (slot >= 0) {
+            // Converte dados para string
+            sprintf(str_tempAHT, "%.1fC", node.temp_cdeg / 100.0f);
+            sprintf(str_umi, "%.1f%%", node.humidity_cpct / 100.0f);
+            sprintf(str_pressao, "%.1fKPa", node.pressure_pa / 1000.0f);
+
+            // Taxa de perda das últimas 64 sequências do nó
+            uint16_t per = link_stats_per_permille(&node.link);
+            snprintf(str_per, sizeof(str_per), "P%u.%u%%", per / 10, per % 10);
+            snprintf(str_no, sizeof(str_no), "NO %u  %u/%u", node.node_id, page, lora_rx_node_count());
+        } else {
+            str_tempAHT[0] = str_umi[0] = str_pressao[0] = str_per[0] = '\0';
+            snprintf(str_no, sizeof(str_no), "AGUARDANDO");
+        }
 
         // Atualiza display com bordas e layout
         ssd1306_fill(&ssd, !cor);                        // Limpa com inversão
@@ -52,7 +79,7 @@ void vTaskDisplay(void *pvParameters) {
         ssd1306_draw_string(&ssd, "AHT10  BMP280", 15, 16);
 
         // --- IP CENTRAL ENTRE AS LINHAS ---
-        ssd1306_draw_string(&ssd, "RECEPTOR", 15, 28);
+        ssd1306_draw_string(&ssd, str_no, 15, 28);
 
         // Dados BMP280 (esquerda)
         ssd1306_draw_string(&ssd, str_umi, 12, 43);
@@ -60,7 +87,7 @@ void vTaskDisplay(void *pvParameters) {
 
         // Dados AHT20 (direita)
         ssd1306_draw_string(&ssd, str_pressao, 66, 43);
-        ssd1306_draw_string(&ssd, "ND", 66, 53);
+        ssd1306_draw_string(&ssd, str_per, 66, 53);
 
         ssd1306_send_data(&ssd);
         vTaskDelay(pdMS_TO_TICKS(1000)); // Atualiza a cada 2s
@@ -0,0 +1,321 @@
+// telemetry_test.c — teste e benchmark no host do quadro binário (telemetry.c)
+// contra o CSV "TS,%.2f,%.2f,%.2f" que ele substituiu.
+//
+// Compilar e rodar (Linux):
+//   gcc -O2 -I.. -I../../sx127x -o telemetry_test telemetry_test.c ../telemetry.c ../../sx127x/sx127x_airtime.c
+//   ./telemetry_test
+//
+// Confere ida e volta de todos os tipos de quadro, a rejeição de versão,
+// tipo e tamanho errados e os extremos das diferenças do lote (int16 nos
+// limites, pressão uint24 saturada), depois compara tempo no ar e tempo de
+// CPU por leitura das duas codificações. Sai com 1 se algum teste falhar.
+// Os ciclos são os do host (rdtsc no x86): servem para a razão entre os
+// dois caminhos, não como valor absoluto no RP2040.
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "telemetry.h"
+#include "sx127x.h"
+
+#define BENCH_ITERATIONS 1000000
+
+static int failures = 0;
+
+#define CHECK(cond) do {                                                  \
+        if (!(cond)) {                                                    \
+            printf("FALHOU %s:%d: %s\n", __FILE__, __LINE__, #cond);      \
+            failures++;                                                   \
+        }                                                                 \
+    } while (0)
+
+// === Ida e volta ===
+
+// Campo a campo: as estruturas têm preenchimento entre os campos
+static bool reading_eq(const telemetry_reading_t *a, const telemetry_reading_t *b) {
+    return a->node_id == b->node_id && a->seq == b->seq && a->flags == b->flags &&
+           a->temp_cdeg == b->temp_cdeg && a->humidity_cpct == b->humidity_cpct &&
+           a->pressure_pa == b->pressure_pa;
+}
+
+static void test_reading(void) {
+    telemetry_reading_t r = { 7, 0xBEEF, TELEMETRY_FLAG_AHT_OK | TELEMETRY_FLAG_BMP_OK,
+                              -1234, 6120, 100840 };
+    uint8_t buf[TELEMETRY_READING_LEN];
+    telemetry_reading_t out;
+
+    CHECK(telemetry_encode(&r, buf, sizeof(buf)) == TELEMETRY_READING_LEN);
+    CHECK(telemetry_encode(&r, buf, sizeof(buf) - 1) == 0);
+    CHECK(telemetry_frame_type(buf, sizeof(buf)) == TELEMETRY_TYPE_READING);
+    CHECK(telemetry_decode(buf, sizeof(buf), &out));
+    CHECK(reading_eq(&r, &out));
+
+    // Extremos dos campos
+    telemetry_reading_t ext = { 255, 0xFFFF, 0xFF, INT16_MIN, UINT16_MAX, 0xFFFFFF };
+    telemetry_encode(&ext, buf, sizeof(buf));
+    CHECK(telemetry_decode(buf, sizeof(buf), &out) && reading_eq(&ext, &out));
+    ext.temp_cdeg = INT16_MAX;
+    telemetry_encode(&ext, buf, sizeof(buf));
+    CHECK(telemetry_decode(buf, sizeof(buf), &out) && out.temp_cdeg == INT16_MAX);
+
+    // Pressão acima de 24 bits satura em vez de dar a volta
+    ext.pressure_pa = 0x1000005;
+    telemetry_encode(&ext, buf, sizeof(buf));
+    CHECK(telemetry_decode(buf, sizeof(buf), &out) && out.pressure_pa == 0xFFFFFF);
+}
+
+static void test_downlink(void) {
+    uint8_t buf[TELEMETRY_BEACON_MAX_LEN];
+
+    telemetry_adr_t a = { 3, 4096, 12, -4 }, a2;
+    CHECK(telemetry_encode_adr(&a, buf, sizeof(buf)) == TELEMETRY_ADR_LEN);
+    CHECK(telemetry_decode_adr(buf, TELEMETRY_ADR_LEN, &a2));
+    CHECK(a2.node_id == 3 && a2.seq == 4096 && a2.sf == 12 && a2.tx_power_dbm == -4);
+
+    telemetry_ack_t k = { 9, 65535, 0x80000001u, false, 0, 0 }, k2;
+    CHECK(telemetry_encode_ack(&k, buf, sizeof(buf)) == TELEMETRY_ACK_LEN);
+    CHECK(telemetry_decode_ack(buf, TELEMETRY_ACK_LEN, &k2));
+    CHECK(k2.last_seq == 65535 && k2.bitmap == 0x80000001u && !k2.has_adr);
+    k.has_adr = true;
+    k.sf = 9;
+    k.tx_power_dbm = 20;
+    CHECK(telemetry_encode_ack(&k, buf, sizeof(buf)) == TELEMETRY_ACK_ADR_LEN);
+    CHECK(telemetry_decode_ack(buf, TELEMETRY_ACK_ADR_LEN, &k2));
+    CHECK(k2.has_adr && k2.sf == 9 && k2.tx_power_dbm == 20);
+
+    telemetry_beacon_t b = { 0xFFFFFFF0u, 10000, 300, 100, 3, { 5, 1, 9 } }, b2;
+    size_t n = telemetry_encode_beacon(&b, buf, sizeof(buf));
+    CHECK(n == TELEMETRY_BEACON_HEADER_LEN + 3);
+    CHECK(telemetry_decode_beacon(buf, n, &b2));
+    CHECK(b2.gateway_ms == 0xFFFFFFF0u && b2.period_ms == 10000 && b2.slot_count == 3);
+    CHECK(telemetry_beacon_slot(&b2, 9) == 2 && telemetry_beacon_slot(&b2, 2) == -1);
+}
+
+// === Rejeição de quadros inválidos ===
+
+static void test_reject(void) {
+    telemetry_reading_t r = { 1, 1, 0, 0, 0, 0 }, out;
+    uint8_t buf[TELEMETRY_READING_LEN + 1];
+    telemetry_encode(&r, buf, sizeof(buf));
+
+    CHECK(!telemetry_decode(buf, TELEMETRY_READING_LEN - 1, &out));   // Curto
+    CHECK(!telemetry_decode(buf, TELEMETRY_READING_LEN + 1, &out));   // Longo
+    CHECK(telemetry_frame_type(buf, 0) == 0);
+
+    uint8_t bad = buf[0];
+    buf[0] = (uint8_t)(((TELEMETRY_VERSION + 1) << 4) | TELEMETRY_TYPE_READING);
+    CHECK(!telemetry_decode(buf, TELEMETRY_READING_LEN, &out));       // Versão
+    CHECK(telemetry_frame_type(buf, TELEMETRY_READING_LEN) == 0);
+    buf[0] = (uint8_t)((TELEMETRY_VERSION << 4) | TELEMETRY_TYPE_ADR);
+    CHECK(!telemetry_decode(buf, TELEMETRY_READING_LEN, &out));       // Tipo
+    buf[0] = bad;
+
+    // Um tipo no lugar do outro
+    telemetry_batch_t batch;
+    telemetry_adr_t adr;
+    telemetry_ack_t ack;
+    CHECK(!telemetry_decode_batch(buf, TELEMETRY_READING_LEN, &batch));
+    CHECK(!telemetry_decode_adr(buf, TELEMETRY_ADR_LEN, &adr));
+    CHECK(!telemetry_decode_ack(buf, TELEMETRY_ACK_LEN, &ack));
+
+    // CSV antigo não passa por quadro binário
+    const char *csv = "TS,25.31,61.20,100.84";
+    CHECK(telemetry_frame_type((const uint8_t *)csv, strlen(csv)) == 0);
+}
+
+// === Lote: diferenças em varint zigzag ===
+
+static size_t batch_roundtrip(const telemetry_batch_t *b, telemetry_batch_t *out) {
+    uint8_t buf[TELEMETRY_BATCH_MAX_LEN];
+    size_t n = telemetry_encode_batch(b, buf, sizeof(buf));
+    CHECK(n > 0);
+    CHECK(telemetry_decode_batch(buf, n, out));
+    CHECK(out->count == b->count && out->seq_first == b->seq_first && out->flags == b->flags);
+    for (uint8_t i = 0; i < b->count && i < out->count; i++) {
+        const telemetry_sample_t *x = &b->samples[i], *y = &out->samples[i];
+        CHECK(x->temp_cdeg == y->temp_cdeg && x->humidity_cpct == y->humidity_cpct &&
+              x->pressure_pa == y->pressure_pa);
+    }
+    return n;
+}
+
+static void test_batch(void) {
+    static telemetry_batch_t b, out;
+    memset(&b, 0, sizeof(b));
+    b.node_id = 1;
+    b.seq_first = 65530;
+    b.interval_ms = 1000;
+    b.flags = TELEMETRY_FLAG_AHT_OK | TELEMETRY_FLAG_BMP_OK;
+
+    // Regime estável: 1 byte por canal em cada amostra seguinte
+    b.count = TELEMETRY_BATCH_MAX;
+    for (int i = 0; i < b.count; i++) {
+        b.samples[i] = (telemetry_sample_t){ (int16_t)(2531 + (i % 3) - 1), (uint16_t)(6120 + i),
+                                             (uint32_t)(100840 - i) };
+    }
+    CHECK(batch_roundtrip(&b, &out) == TELEMETRY_BATCH_HEADER_LEN + (TELEMETRY_BATCH_MAX - 1) * 3);
+
+    // Extremos do int16: a diferença ocupa 17 bits com sinal
+    b.count = 3;
+    b.samples[0] = (telemetry_sample_t){ INT16_MIN, 0, 0 };
+    b.samples[1] = (telemetry_sample_t){ INT16_MAX, UINT16_MAX, 0xFFFFFF };
+    b.samples[2] = (telemetry_sample_t){ -1, 1, 1 };
+    batch_roundtrip(&b, &out);
+    b.samples[0] = (telemetry_sample_t){ INT16_MAX, UINT16_MAX, 0xFFFFFF };
+    b.samples[1] = (telemetry_sample_t){ INT16_MIN, 0, 0 };
+    b.samples[2] = (telemetry_sample_t){ 0, 0x8000, 0x800000 };
+    batch_roundtrip(&b, &out);
+
+    // Pior caso cabe em TELEMETRY_BATCH_MAX_LEN
+    b.count = TELEMETRY_BATCH_MAX;
+    for (int i = 1; i < b.count; i++) {
+        b.samples[i] = (i & 1) ? (telemetry_sample_t){ INT16_MIN, 0, 0 } : b.samples[0];
+    }
+    batch_roundtrip(&b, &out);
+
+    // Pressão acima de 24 bits na primeira amostra satura; nas seguintes a
+    // diferença é relativa ao valor saturado
+    b.count = 2;
+    b.samples[0] = (telemetry_sample_t){ 0, 0, 0x1000000 };
+    b.samples[1] = (telemetry_sample_t){ 0, 0, 0xFFFFF0 };
+    uint8_t buf[TELEMETRY_BATCH_MAX_LEN];
+    size_t n = telemetry_encode_batch(&b, buf, sizeof(buf));
+    CHECK(n > 0 && telemetry_decode_batch(buf, n, &out));
+    CHECK(out.samples[0].pressure_pa == 0xFFFFFF);
+    CHECK(out.samples[1].pressure_pa == 0xFFFFFF - (0x1000000 - 0xFFFFF0));
+
+    // Contagem inválida, buffer curto, truncado e com lixo no fim
+    b.count = 0;
+    CHECK(telemetry_encode_batch(&b, buf, sizeof(buf)) == 0);
+    b.count = TELEMETRY_BATCH_MAX + 1;
+    CHECK(telemetry_encode_batch(&b, buf, sizeof(buf)) == 0);
+    b.count = 3;
+    b.samples[0] = (telemetry_sample_t){ 0, 0, 0 };
+    b.samples[1] = (telemetry_sample_t){ INT16_MAX, 0, 0 };
+    b.samples[2] = (telemetry_sample_t){ 0, 0, 0 };
+    n = telemetry_encode_batch(&b, buf, sizeof(buf));
+    CHECK(telemetry_encode_batch(&b, buf, n - 1) == 0);
+    CHECK(!telemetry_decode_batch(buf, n - 1, &out));
+    buf[n] = 0;
+    CHECK(!telemetry_decode_batch(buf, n + 1, &out));
+    buf[4] = TELEMETRY_BATCH_MAX + 1;
+    CHECK(!telemetry_decode_batch(buf, n, &out));
+
+    // Varint longo demais (mais de 5 bytes de continuação)
+    b.count = 2;
+    n = telemetry_encode_batch(&b, buf, sizeof(buf));
+    memset(&buf[TELEMETRY_BATCH_HEADER_LEN], 0xFF, 6);
+    CHECK(!telemetry_decode_batch(buf, TELEMETRY_BATCH_HEADER_LEN + 8, &out));
+}
+
+// === Benchmark: CSV (snprintf/strtok/atof) contra o quadro binário ===
+
+static inline uint64_t bench_now(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BENCH_UNIT "ciclos"
+#else
+#define BENCH_UNIT "ns"
+#endif
+
+// Caminho antigo, como estava nas duas estações
+static int csv_encode(float t, float u, float p, char *buf, size_t len) {
+    return snprintf(buf, len, "TS,%.2f,%.2f,%.2f", t, u, p);
+}
+
+static bool csv_decode(char *buf, float *t, float *u, float *p) {
+    char *token = strtok(buf, ",");
+    if (!token || strcmp(token, "TS") != 0) return false;
+    if ((token = strtok(NULL, ",")) == NULL) return false;
+    *t = (float)atof(token);
+    if ((token = strtok(NULL, ",")) == NULL) return false;
+    *u = (float)atof(token);
+    if ((token = strtok(NULL, ",")) == NULL) return false;
+    *p = (float)atof(token);
+    return true;
+}
+
+static volatile uint32_t bench_sink;
+
+static void bench(void) {
+    char csv[32], work[32];
+    uint8_t bin[TELEMETRY_READING_LEN];
+    float t, u, p;
+    telemetry_reading_t r = { 1, 0, TELEMETRY_FLAG_AHT_OK | TELEMETRY_FLAG_BMP_OK, 0, 0, 0 }, out;
+
+    // Valores variam a cada iteração para o compilador não dobrar o laço
+    uint64_t t0 = bench_now();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+        bench_sink += (uint32_t)csv_encode(25.31f + (i & 7), 61.2f, 100.84f, csv, sizeof(csv));
+    }
+    uint64_t csv_enc = bench_now() - t0;
+
+    t0 = bench_now();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+        memcpy(work, csv, sizeof(work));
+        bench_sink += csv_decode(work, &t, &u, &p) ? (uint32_t)t : 0;
+    }
+    uint64_t csv_dec = bench_now() - t0;
+
+    t0 = bench_now();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+        r.seq = (uint16_t)i;
+        r.temp_cdeg = (int16_t)(2531 + (i & 7));
+        bench_sink += (uint32_t)telemetry_encode(&r, bin, sizeof(bin));
+    }
+    uint64_t bin_enc = bench_now() - t0;
+
+    t0 = bench_now();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+        bin[2] = (uint8_t)i;
+        bench_sink += telemetry_decode(bin, sizeof(bin), &out) ? out.seq : 0;
+    }
+    uint64_t bin_dec = bench_now() - t0;
+
+    printf("\nCPU por leitura (%s no host, média de %u):\n", BENCH_UNIT, BENCH_ITERATIONS);
+    printf("  %-10s %10s %10s\n", "", "codifica", "decodifica");
+    printf("  %-10s %10.1f %10.1f\n", "CSV", (double)csv_enc / BENCH_ITERATIONS,
+           (double)csv_dec / BENCH_ITERATIONS);
+    printf("  %-10s %10.1f %10.1f\n", "binário", (double)bin_enc / BENCH_ITERATIONS,
+           (double)bin_dec / BENCH_ITERATIONS);
+    printf("  %-10s %9.1fx %9.1fx\n", "razão", (double)csv_enc / (double)bin_enc,
+           (double)csv_dec / (double)bin_dec);
+
+    // Tempo no ar com o perfil padrão, para o CSV típico e o pior caso
+    uint8_t csv_typ = (uint8_t)csv_encode(25.31f, 61.2f, 100.84f, csv, sizeof(csv));
+    uint8_t csv_max = (uint8_t)csv_encode(-40.0f, 100.0f, 110.0f, csv, sizeof(csv));
+    sx127x_profile_t prof = SX127X_PROFILE_DEFAULT;
+    printf("\nTempo no ar, perfil padrão (CSV típico %u B, pior caso %u B; binário %u B):\n",
+           csv_typ, csv_max, TELEMETRY_READING_LEN);
+    printf("  %-5s %12s %12s %12s %8s\n", "SF", "CSV típico", "CSV máx.", "binário", "ganho");
+    for (uint8_t sf = 7; sf <= 12; sf++) {
+        prof.sf = sf;
+        uint32_t a = sx127x_time_on_air_us(&prof, csv_typ);
+        uint32_t m = sx127x_time_on_air_us(&prof, csv_max);
+        uint32_t b = sx127x_time_on_air_us(&prof, TELEMETRY_READING_LEN);
+        printf("  SF%-3u %9.1f ms %9.1f ms %9.1f ms %7.1f%%\n", sf, a / 1000.0, m / 1000.0,
+               b / 1000.0, 100.0 * (a - b) / a);
+        CHECK(b < a);
+    }
+}
+
+int main(void) {
+    test_reading();
+    test_downlink();
+    test_reject();
+    test_batch();
+    printf("Testes do codec: %s (%d falhas)\n", failures ? "FALHOU" : "ok", failures);
+
+    bench();
+    return failures ? 1 : 0;
+}
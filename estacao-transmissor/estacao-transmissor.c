@@ -6,16 +6,20 @@
 #include "lib/config_btn.h"
 #include "lib/task_sensores.h"
 #include "lib/task_display.h"
+#include "lib/task_radio.h"
 #include "lib/task_LoRa.h"
 
 int main() {
     stdio_init_all();
     init_btn_callback();
+    radio_tx_queue_init();
+    sensores_queues_init();
 
     // Cria a tasks
     xTaskCreate(vTaskSensores, "Sensores", 1024, NULL, 2, NULL);
     xTaskCreate(vTaskDisplay, "Display", 1024, NULL, 1, NULL);
-    xTaskCreate(vTaskLoRaTX, "LoRa", 1024, NULL, 1, NULL);
+    xTaskCreate(vTaskLoRaTX, "LoRa", 1024, NULL, 2, NULL);     // Antes do display na leitura nova
+    xTaskCreate(vTaskRadio, "Radio", 1024, NULL, 3, NULL);
 
     // Inicia o agendador do FreeRTOS
     vTaskStartScheduler();
@@ -42,7 +42,8 @@
 
 /* Scheduler Related */
 #define configUSE_PREEMPTION                    1
-#define configUSE_TICKLESS_IDLE                 0
+#define configUSE_TICKLESS_IDLE                 1
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP   2
 #define configUSE_IDLE_HOOK                     0
 #define configUSE_TICK_HOOK                     0
 #define configTICK_RATE_HZ                      ( ( TickType_t ) 1000 )
@@ -59,6 +60,7 @@
 #define configUSE_COUNTING_SEMAPHORES           1
 #define configQUEUE_REGISTRY_SIZE               8
 #define configUSE_QUEUE_SETS                    1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES   2   /* 1: espera de DMA do i2c_bus */
 #define configUSE_TIME_SLICING                  1
 #define configUSE_NEWLIB_REENTRANT              0
 #define configENABLE_BACKWARD_COMPATIBILITY     0
@@ -135,4 +137,12 @@ to exclude the API function. */
 
 /* A header file that defines trace macro can be included here. */
 
+/* Tickless idle: tempo dormindo contabilizado na estimativa de consumo (task_radio.h) */
+#ifndef __ASSEMBLER__
+void radio_mcu_idle_begin(void);
+void radio_mcu_idle_end(void);
+#endif
+#define traceLOW_POWER_IDLE_BEGIN()             radio_mcu_idle_begin()
+#define traceLOW_POWER_IDLE_END()               radio_mcu_idle_end()
+
 #endif /* FREERTOS_CONFIG_H */
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "i2c_bus.h"
 #include "aht20.h"
 
 #define AHT20_I2C_ADDR      0x38
@@ -9,50 +10,48 @@
 #define AHT20_CMD_RESET     0xBA
 #define AHT20_STATUS_BUSY   0x80  // Bit de status ocupado
 #define AHT20_STATUS_CALIBRATED 0x08  // Bit de calibração
+#define AHT20_FRAME_LEN     7     // Status + 5 bytes de dados + CRC
+
+// CRC-8 do datasheet: polinômio x^8 + x^5 + x^4 + 1 (0x31), valor inicial 0xFF
+static uint8_t aht20_crc8(const uint8_t *data, size_t len) {
+    uint8_t crc = 0xFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
 
 bool aht20_init(i2c_inst_t *i2c) {
     uint8_t init_cmd[3] = {AHT20_CMD_INIT, 0x08, 0x00};
-    i2c_write_blocking(i2c, AHT20_I2C_ADDR, init_cmd, 3, false);
-    sleep_ms(50);  // Aguarda o sensor inicializar
+    return i2c_bus_write(i2c, AHT20_I2C_ADDR, init_cmd, 3) == 3;
+}
 
-    // Verifica status até que o sensor esteja pronto
+bool aht20_is_calibrated(i2c_inst_t *i2c) {
     uint8_t status;
-    for (int i = 0; i < 10; i++) {
-        i2c_read_blocking(i2c, AHT20_I2C_ADDR, &status, 1, false);
-        if ((status & AHT20_STATUS_CALIBRATED) == AHT20_STATUS_CALIBRATED) {
-            return true;  // Sensor calibrado e pronto
-        }
-        sleep_ms(10);
-    }
-
-    return false;  // Falhou na calibração
+    if (i2c_bus_read(i2c, AHT20_I2C_ADDR, &status, 1) != 1) return false;
+    return (status & AHT20_STATUS_CALIBRATED) == AHT20_STATUS_CALIBRATED;
 }
 
-bool aht20_read(i2c_inst_t *i2c, AHT20_Data *data) {
+bool aht20_trigger(i2c_inst_t *i2c) {
     uint8_t trigger_cmd[3] = {AHT20_CMD_TRIGGER, 0x33, 0x00};
-    uint8_t buffer[6];
+    return i2c_bus_write(i2c, AHT20_I2C_ADDR, trigger_cmd, 3) == 3;
+}
 
-    // Envia comando de medição
-    i2c_write_blocking(i2c, AHT20_I2C_ADDR, trigger_cmd, 3, false);
-    
-    // Aguarda até o sensor estar pronto
-    uint8_t status;
-    for (int i = 0; i < 10; i++) {
-        i2c_read_blocking(i2c, AHT20_I2C_ADDR, &status, 1, false);
-        if (!(status & AHT20_STATUS_BUSY)) {
-            break;
-        }
-        sleep_ms(10);
+aht20_result_t aht20_fetch(i2c_inst_t *i2c, AHT20_Data *data) {
+    uint8_t buffer[AHT20_FRAME_LEN];
+
+    // Status, umidade e temperatura (20 bits cada) e CRC em uma única leitura
+    if (i2c_bus_read(i2c, AHT20_I2C_ADDR, buffer, sizeof(buffer)) != sizeof(buffer)) {
+        return AHT20_ERROR;
     }
-    
-    // Se ainda estiver ocupado, falha na leitura
-    if (status & AHT20_STATUS_BUSY) {
-        return false;
+    if (buffer[0] & AHT20_STATUS_BUSY) {
+        return AHT20_BUSY;
     }
-
-    // Lê os 6 bytes de dados
-    if (i2c_read_blocking(i2c, AHT20_I2C_ADDR, buffer, 6, false) != 6) {
-        return false;
+    if (aht20_crc8(buffer, AHT20_FRAME_LEN - 1) != buffer[AHT20_FRAME_LEN - 1]) {
+        return AHT20_ERROR;
     }
 
     // Processa os dados de umidade (20 bits)
@@ -63,17 +62,27 @@ bool aht20_read(i2c_inst_t *i2c, AHT20_Data *data) {
     uint32_t raw_temp = ((uint32_t)(buffer[3] & 0x0F) << 16) | ((uint32_t)buffer[4] << 8) | buffer[5];
     data->temperature = ((float)raw_temp * 200.0 / 1048576.0) - 50.0;
 
-    return true;
+    return AHT20_READY;
+}
+
+bool aht20_read(i2c_inst_t *i2c, AHT20_Data *data) {
+    if (!aht20_trigger(i2c)) return false;
+    sleep_ms(AHT20_MEASURE_MS);
+
+    aht20_result_t result = aht20_fetch(i2c, data);
+    for (int i = 0; i < AHT20_FETCH_RETRIES && result == AHT20_BUSY; i++) {
+        sleep_ms(AHT20_RETRY_MS);
+        result = aht20_fetch(i2c, data);
+    }
+    return result == AHT20_READY;
 }
 
-void aht20_reset(i2c_inst_t *i2c) {
+bool aht20_reset(i2c_inst_t *i2c) {
     uint8_t reset_cmd = AHT20_CMD_RESET;
-    i2c_write_blocking(i2c, AHT20_I2C_ADDR, &reset_cmd, 1, false);
-    sleep_ms(20);
-    aht20_init(i2c);
+    return i2c_bus_write(i2c, AHT20_I2C_ADDR, &reset_cmd, 1) == 1;
 }
 
 bool aht20_check(i2c_inst_t *i2c) {
     uint8_t status;
-    return i2c_read_blocking(i2c, AHT20_I2C_ADDR, &status, 1, false) == 1;
+    return i2c_bus_read(i2c, AHT20_I2C_ADDR, &status, 1) == 1;
 }
@@ -10,20 +10,47 @@
 #define AHT20_CMD_TRIGGER   0xAC
 #define AHT20_CMD_RESET     0xBA
 
+// Esperas do datasheet (ms) entre um comando e o passo seguinte. A biblioteca
+// não dorme: quem chama espera (vTaskDelay na task, sleep_ms sem RTOS).
+#define AHT20_RESET_MS      20    // Após aht20_reset()
+#define AHT20_INIT_MS       10    // Após aht20_init(), antes de aht20_is_calibrated()
+#define AHT20_MEASURE_MS    80    // Entre aht20_trigger() e aht20_fetch()
+
+// Conversão mais longa que AHT20_MEASURE_MS: novas chamadas de aht20_fetch()
+// enquanto der AHT20_BUSY, espaçadas de AHT20_RETRY_MS
+#define AHT20_FETCH_RETRIES 3
+#define AHT20_RETRY_MS      10
+
 // Estrutura para armazenar os valores de temperatura e umidade
 typedef struct {
     float temperature;
     float humidity;
 } AHT20_Data;
 
-// Inicializa o sensor AHT20
+// Resultado de aht20_fetch()
+typedef enum {
+    AHT20_READY = 0,      // Medição copiada para 'data'
+    AHT20_BUSY,           // Conversão ainda em andamento: tentar de novo em instantes
+    AHT20_ERROR,          // Falha no I2C ou CRC inválido
+} aht20_result_t;
+
+// Envia o comando de calibração (aguardar AHT20_INIT_MS)
 bool aht20_init(i2c_inst_t *i2c);
 
-// Faz a leitura de temperatura e umidade do AHT20
+// Bit de calibração do status
+bool aht20_is_calibrated(i2c_inst_t *i2c);
+
+// Dispara uma medição (aguardar AHT20_MEASURE_MS antes de aht20_fetch)
+bool aht20_trigger(i2c_inst_t *i2c);
+
+// Lê status, 5 bytes de dados e o CRC da medição disparada
+aht20_result_t aht20_fetch(i2c_inst_t *i2c, AHT20_Data *data);
+
+// Leitura completa e bloqueante (trigger + sleep_ms + fetch), para uso sem RTOS
 bool aht20_read(i2c_inst_t *i2c, AHT20_Data *data);
 
-// Reseta o sensor AHT20
-void aht20_reset(i2c_inst_t *i2c);
+// Reset por software (aguardar AHT20_RESET_MS e chamar aht20_init)
+bool aht20_reset(i2c_inst_t *i2c);
 
 bool aht20_check(i2c_inst_t *i2c);
 
@@ -0,0 +1,121 @@
+#include "arq.h"
+#include <string.h>
+
+// xorshift32: jitter barato e determinístico a partir da semente
+static uint32_t arq_rand(arq_t *a) {
+    uint32_t x = a->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    a->rng = x;
+    return x;
+}
+
+// Backoff exponencial com jitter uniforme em [0, base): evita que reenvios
+// de nós diferentes colidam de novo no mesmo instante
+static uint32_t arq_backoff_ms(arq_t *a, uint8_t attempts) {
+    uint32_t base = ARQ_BACKOFF_MS << (attempts - 1);
+    return base + arq_rand(a) % base;
+}
+
+// Diferença com sinal em 32 bits: tolera o estouro do relógio em ms
+static inline bool arq_reached(uint32_t now_ms, uint32_t due_ms) {
+    return (int32_t)(now_ms - due_ms) >= 0;
+}
+
+void arq_init(arq_t *a, uint32_t seed) {
+    memset(a, 0, sizeof(*a));
+    a->rng = seed ? seed : 0x9E3779B9u;
+}
+
+bool arq_full(const arq_t *a) {
+    for (int i = 0; i < ARQ_SLOTS; i++) {
+        if (!a->slots[i].used) return false;
+    }
+    return true;
+}
+
+int arq_track(arq_t *a, const uint8_t *data, uint8_t len, uint16_t seq_first, uint8_t count,
+              uint32_t id, void *ctx, uint32_t now_ms) {
+    for (int i = 0; i < ARQ_SLOTS; i++) {
+        arq_slot_t *s = &a->slots[i];
+        if (s->used) continue;
+        s->used = true;
+        s->attempts = 1;
+        s->count = count;
+        s->seq_first = seq_first;
+        s->due_ms = now_ms + arq_backoff_ms(a, 1);
+        s->id = id;
+        s->ctx = ctx;
+        s->len = len;
+        memcpy(s->data, data, len);
+        return i;
+    }
+    return -1;
+}
+
+static bool arq_covered(const arq_slot_t *s, uint16_t last_seq, uint32_t bitmap) {
+    for (uint8_t k = 0; k < s->count; k++) {
+        uint16_t age = (uint16_t)(last_seq - (uint16_t)(s->seq_first + k));
+        if (age >= 32 || (bitmap & (1u << age)) == 0) return false;
+    }
+    return true;
+}
+
+int arq_ack(arq_t *a, uint16_t last_seq, uint32_t bitmap, arq_done_t done, void *user) {
+    int freed = 0;
+    for (int i = 0; i < ARQ_SLOTS; i++) {
+        arq_slot_t *s = &a->slots[i];
+        if (!s->used || !arq_covered(s, last_seq, bitmap)) continue;
+        s->used = false;
+        a->acked++;
+        freed++;
+        if (done) done(s, ARQ_ACKED, user);
+    }
+    return freed;
+}
+
+int arq_next_due(arq_t *a, uint32_t now_ms, uint32_t *wait_ms) {
+    int best = -1;
+    uint32_t wait = UINT32_MAX;
+    for (int i = 0; i < ARQ_SLOTS; i++) {
+        arq_slot_t *s = &a->slots[i];
+        if (!s->used || s->attempts >= ARQ_MAX_ATTEMPTS) continue;
+        if (arq_reached(now_ms, s->due_ms)) {
+            // Vencidos: o mais antigo primeiro
+            if (best < 0 || (int32_t)(s->due_ms - a->slots[best].due_ms) < 0) best = i;
+            wait = 0;
+        } else if (best < 0 && s->due_ms - now_ms < wait) {
+            wait = s->due_ms - now_ms;
+        }
+    }
+    // Quadros na última tentativa ainda ocupam o slot até expirar
+    for (int i = 0; i < ARQ_SLOTS && best < 0; i++) {
+        arq_slot_t *s = &a->slots[i];
+        if (!s->used || s->attempts < ARQ_MAX_ATTEMPTS) continue;
+        uint32_t left = arq_reached(now_ms, s->due_ms) ? 0 : s->due_ms - now_ms;
+        if (left < wait) wait = left;
+    }
+    *wait_ms = wait;
+    return best;
+}
+
+void arq_resent(arq_t *a, int slot, uint32_t now_ms) {
+    arq_slot_t *s = &a->slots[slot];
+    s->attempts++;
+    s->due_ms = now_ms + arq_backoff_ms(a, s->attempts);
+    a->retransmissions++;
+}
+
+int arq_expire(arq_t *a, uint32_t now_ms, arq_done_t done, void *user) {
+    int n = 0;
+    for (int i = 0; i < ARQ_SLOTS; i++) {
+        arq_slot_t *s = &a->slots[i];
+        if (!s->used || s->attempts < ARQ_MAX_ATTEMPTS || !arq_reached(now_ms, s->due_ms)) continue;
+        s->used = false;
+        a->expired++;
+        n++;
+        if (done) done(s, ARQ_EXPIRED, user);
+    }
+    return n;
+}
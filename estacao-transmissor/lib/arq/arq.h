@@ -0,0 +1,73 @@
+#ifndef ARQ_H
+#define ARQ_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Retransmissão seletiva de quadros confirmados por sequência.
+// Cada quadro enviado fica guardado até que uma confirmação (última sequência
+// + bitmap) cubra todas as suas sequências; sem confirmação ele é reenviado
+// com backoff exponencial e jitter, até ARQ_MAX_ATTEMPTS envios.
+// Como a confirmação é cumulativa, um único ACK libera vários quadros
+// (inclusive os que aguardavam reenvio).
+// Sem dependência do SDK: o tempo é passado pelo chamador.
+
+#define ARQ_SLOTS           4       // Quadros aguardando confirmação
+#define ARQ_FRAME_MAX       255
+#define ARQ_MAX_ATTEMPTS    4       // Envios por quadro (1 original + 3 reenvios)
+#define ARQ_BACKOFF_MS      1000    // Espera antes do 1º reenvio; dobra a cada tentativa
+
+typedef enum {
+    ARQ_ACKED = 0,          // Todas as sequências confirmadas
+    ARQ_EXPIRED,            // Esgotou as tentativas
+} arq_result_t;
+
+typedef struct {
+    bool used;
+    uint8_t attempts;       // Envios já feitos
+    uint8_t count;          // Sequências no quadro
+    uint16_t seq_first;
+    uint32_t due_ms;        // Próximo reenvio
+    uint32_t id;            // Identificador do chamador
+    void *ctx;              // Contexto do chamador (ex.: callback de conclusão)
+    uint8_t len;
+    uint8_t data[ARQ_FRAME_MAX];
+} arq_slot_t;
+
+typedef void (*arq_done_t)(const arq_slot_t *slot, arq_result_t result, void *user);
+
+typedef struct {
+    arq_slot_t slots[ARQ_SLOTS];
+    uint32_t rng;           // Estado do gerador do jitter
+    uint32_t retransmissions;
+    uint32_t acked;
+    uint32_t expired;
+} arq_t;
+
+// 'seed' != 0 varia o jitter entre nós que compartilham o canal
+void arq_init(arq_t *a, uint32_t seed);
+
+// Sem slot livre o chamador deve segurar novos quadros
+bool arq_full(const arq_t *a);
+
+// Guarda um quadro que acabou de ser enviado pela primeira vez.
+// Retorna o slot ou -1 se não houver espaço.
+int arq_track(arq_t *a, const uint8_t *data, uint8_t len, uint16_t seq_first, uint8_t count,
+              uint32_t id, void *ctx, uint32_t now_ms);
+
+// Aplica uma confirmação: libera (ARQ_ACKED) os quadros cobertos por
+// 'last_seq' + 'bitmap' (bit i = last_seq - i). Retorna quantos foram liberados.
+int arq_ack(arq_t *a, uint16_t last_seq, uint32_t bitmap, arq_done_t done, void *user);
+
+// Slot com reenvio vencido, ou -1. Em 'wait_ms' devolve quanto falta para o
+// próximo vencimento (UINT32_MAX se nada estiver pendente).
+int arq_next_due(arq_t *a, uint32_t now_ms, uint32_t *wait_ms);
+
+// Registra o reenvio de um slot; na última tentativa sem sucesso o quadro
+// expira (ARQ_EXPIRED) no vencimento seguinte
+void arq_resent(arq_t *a, int slot, uint32_t now_ms);
+
+// Expira os quadros que já usaram todas as tentativas e venceram sem ACK
+int arq_expire(arq_t *a, uint32_t now_ms, arq_done_t done, void *user);
+
+#endif
@@ -0,0 +1,131 @@
+// arq_sim.c — simulação no host da retransmissão seletiva (arq.c) sobre um
+// canal com perdas independentes no uplink e no downlink.
+//
+// Compilar e rodar (Linux):
+//   gcc -O2 -I.. -o arq_sim arq_sim.c ../arq.c && ./arq_sim [amostras_por_quadro]
+//
+// Para cada taxa de perda mostra a entrega (sequências distintas recebidas /
+// geradas), o goodput (sequências entregues por transmissão) e a média de
+// envios por quadro, comparando com o envio sem confirmação.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "arq.h"
+
+#define SIM_DURATION_MS   (6 * 60 * 60 * 1000)  // 6 h de operação
+#define SIM_PERIOD_MS     10000                 // Um quadro novo a cada 10 s
+#define SIM_BUSY_MS       260                   // Tempo no ar (SF7, 12 B) + janela de RX
+
+typedef struct {
+    double loss;              // Probabilidade de perda em cada sentido
+    uint32_t rng;
+    // Receptor
+    bool started;
+    uint16_t last_seq;
+    uint32_t bitmap;          // bit i = last_seq - i recebida
+    uint32_t delivered;       // Sequências distintas entregues
+    // Transmissor
+    uint32_t transmissions;
+} sim_t;
+
+static double sim_uniform(sim_t *s) {
+    s->rng ^= s->rng << 13;
+    s->rng ^= s->rng >> 17;
+    s->rng ^= s->rng << 5;
+    return (s->rng & 0xFFFFFF) / (double)0x1000000;
+}
+
+// Receptor: marca as sequências no bitmap (mesma convenção do ACK)
+static void sim_receive(sim_t *s, uint16_t seq_first, uint8_t count) {
+    for (uint8_t k = 0; k < count; k++) {
+        uint16_t seq = (uint16_t)(seq_first + k);
+        if (!s->started) {
+            s->started = true;
+            s->last_seq = seq;
+            s->bitmap = 1;
+            s->delivered++;
+            continue;
+        }
+        int16_t ahead = (int16_t)(seq - s->last_seq);
+        if (ahead > 0) {
+            s->bitmap = ahead >= 32 ? 0 : s->bitmap << ahead;
+            s->bitmap |= 1;
+            s->last_seq = seq;
+            s->delivered++;
+        } else if (-ahead < 32 && (s->bitmap & (1u << -ahead)) == 0) {
+            s->bitmap |= 1u << -ahead;
+            s->delivered++;
+        }
+    }
+}
+
+// Um envio pelo canal; devolve true se o ACK voltou
+static bool sim_send(sim_t *s, uint16_t seq_first, uint8_t count) {
+    s->transmissions++;
+    if (sim_uniform(s) < s->loss) return false;      // Uplink perdido
+    sim_receive(s, seq_first, count);
+    return sim_uniform(s) >= s->loss;                 // ACK perdido?
+}
+
+static void sim_run(double loss, uint8_t count, bool use_ack) {
+    sim_t s = { .loss = loss, .rng = 12345 };
+    arq_t arq;
+    arq_init(&arq, 1);
+
+    uint32_t generated = 0;
+    uint16_t seq = 0;
+    uint32_t now = 0, next_new = 0;
+    while (now < SIM_DURATION_MS) {
+        arq_expire(&arq, now, NULL, NULL);
+
+        uint32_t wait = UINT32_MAX;
+        int slot = use_ack ? arq_next_due(&arq, now, &wait) : -1;
+        if (slot >= 0) {
+            arq_slot_t *f = &arq.slots[slot];
+            arq_resent(&arq, slot, now);
+            if (sim_send(&s, f->seq_first, f->count)) arq_ack(&arq, s.last_seq, s.bitmap, NULL, NULL);
+            now += SIM_BUSY_MS;
+            continue;
+        }
+
+        if ((int32_t)(now - next_new) >= 0 && !arq_full(&arq)) {
+            uint8_t frame[1] = { 0 };
+            bool acked = sim_send(&s, seq, count);
+            if (use_ack) {
+                if (acked) arq_ack(&arq, s.last_seq, s.bitmap, NULL, NULL);
+                else arq_track(&arq, frame, sizeof(frame), seq, count, 0, NULL, now);
+            }
+            seq = (uint16_t)(seq + count);
+            generated += count;
+            next_new += SIM_PERIOD_MS;
+            now += SIM_BUSY_MS;
+            continue;
+        }
+
+        uint32_t until_new = (int32_t)(next_new - now) > 0 ? next_new - now : 0;
+        if (arq_full(&arq) || until_new == 0) until_new = UINT32_MAX;
+        uint32_t step = wait < until_new ? wait : until_new;
+        now += step == UINT32_MAX ? 1 : (step ? step : 1);
+    }
+
+    double delivery = generated ? 100.0 * s.delivered / generated : 0.0;
+    double goodput = s.transmissions ? (double)s.delivered / s.transmissions : 0.0;
+    double per_frame = generated ? (double)s.transmissions * count / generated : 0.0;
+    printf("%5.0f%%  %-7s  %7.2f%%  %7.3f  %6.2f  %8lu  %6lu\n",
+           loss * 100.0, use_ack ? "ACK" : "sem ACK", delivery, goodput, per_frame,
+           (unsigned long)arq.retransmissions, (unsigned long)arq.expired);
+}
+
+int main(int argc, char **argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 1;
+    if (count < 1 || count > 16) count = 1;
+
+    printf("Amostras por quadro: %d, um quadro a cada %d ms\n", count, SIM_PERIOD_MS);
+    printf("perda   modo       entrega  goodput  envios  reenvios  expir.\n");
+    static const double losses[] = { 0.0, 0.05, 0.10, 0.20, 0.30, 0.50 };
+    for (size_t i = 0; i < sizeof(losses) / sizeof(losses[0]); i++) {
+        sim_run(losses[i], (uint8_t)count, false);
+        sim_run(losses[i], (uint8_t)count, true);
+    }
+    return 0;
+}
@@ -1,28 +1,65 @@
 #include "bmp280.h"
 #include "hardware/i2c.h"
+#include "i2c_bus.h"
 
 #define ADDR _u(0x76)
 
 void bmp280_init(i2c_inst_t *i2c) {
+    const bmp280_config_t cfg = BMP280_CONFIG_DEFAULT;
+    bmp280_configure(i2c, &cfg);
+}
+
+// Valor de ctrl_meas: osrs_t (7-5) | osrs_p (4-2) | modo (1-0)
+static uint8_t bmp280_ctrl_meas(const bmp280_config_t *cfg, bmp280_mode_t mode) {
+    return (uint8_t)((cfg->osrs_t << 5) | (cfg->osrs_p << 2) | mode);
+}
+
+void bmp280_configure(i2c_inst_t *i2c, const bmp280_config_t *cfg) {
     uint8_t buf[2];
-    const uint8_t reg_config_val = ((0x04 << 5) | (0x05 << 2)) & 0xFC;
+
+    // config só é aceito de forma confiável em sleep: desliga antes de mudar
+    buf[0] = REG_CTRL_MEAS;
+    buf[1] = bmp280_ctrl_meas(cfg, BMP280_MODE_SLEEP);
+    i2c_bus_write(i2c, ADDR, buf, 2);
+
+    // config: t_sb (7-5) | filter (4-2) | spi3w_en (0)
     buf[0] = REG_CONFIG;
-    buf[1] = reg_config_val;
-   
-    i2c_write_blocking(i2c, ADDR, buf, 2, false);
+    buf[1] = (uint8_t)((cfg->standby << 5) | (cfg->filter << 2));
+    i2c_bus_write(i2c, ADDR, buf, 2);
 
-    const uint8_t reg_ctrl_meas_val = (0x01 << 5) | (0x03 << 2) | (0x03);
+    // No modo forçado a primeira medição só sai em bmp280_trigger()
     buf[0] = REG_CTRL_MEAS;
-    buf[1] = reg_ctrl_meas_val;
-    i2c_write_blocking(i2c, ADDR, buf, 2, false);
- //   printf("Ctrl_meas register value: %x\n", reg_ctrl_meas_val);
+    buf[1] = bmp280_ctrl_meas(cfg, cfg->mode == BMP280_MODE_FORCED ? BMP280_MODE_SLEEP : cfg->mode);
+    i2c_bus_write(i2c, ADDR, buf, 2);
+}
+
+void bmp280_trigger(i2c_inst_t *i2c, const bmp280_config_t *cfg) {
+    uint8_t buf[2] = { REG_CTRL_MEAS, bmp280_ctrl_meas(cfg, BMP280_MODE_FORCED) };
+    i2c_bus_write(i2c, ADDR, buf, 2);
+}
+
+bool bmp280_is_measuring(i2c_inst_t *i2c) {
+    uint8_t reg = REG_STATUS, status = 0;
+    i2c_bus_write_read(i2c, ADDR, &reg, 1, &status, 1);
+    return (status & 0x08) != 0;
+}
+
+// Fator de sobreamostragem do código osrs (SKIP = 0)
+static uint32_t bmp280_osrs_factor(bmp280_osrs_t osrs) {
+    return osrs == BMP280_OSRS_SKIP ? 0 : 1u << (osrs - 1);
+}
+
+uint32_t bmp280_measure_time_us(const bmp280_config_t *cfg) {
+    // Máximo: 1,25 ms + 2,3 ms por amostra de T + (2,3 ms por amostra de P + 0,575 ms)
+    uint32_t t = 1250 + 2300 * bmp280_osrs_factor(cfg->osrs_t);
+    if (cfg->osrs_p != BMP280_OSRS_SKIP) t += 2300 * bmp280_osrs_factor(cfg->osrs_p) + 575;
+    return t;
 }
 
 void bmp280_read_raw(i2c_inst_t *i2c, int32_t* temp, int32_t* pressure) {
     uint8_t buf[6];
     uint8_t reg = REG_PRESSURE_MSB;
-    i2c_write_blocking(i2c, ADDR, &reg, 1, true);
-    i2c_read_blocking(i2c, ADDR, buf, 6, false);
+    i2c_bus_write_read(i2c, ADDR, &reg, 1, buf, 6);
 
     *pressure = (buf[0] << 12) | (buf[1] << 4) | (buf[2] >> 4);
     *temp = (buf[3] << 12) | (buf[4] << 4) | (buf[5] >> 4);
@@ -32,12 +69,12 @@ void bmp280_read_raw(i2c_inst_t *i2c, int32_t* temp, int32_t* pressure) {
 
 void bmp280_reset(i2c_inst_t *i2c) {
     uint8_t buf[2] = { REG_RESET, 0xB6 };
-    i2c_write_blocking(i2c, ADDR, buf, 2, false);
+    i2c_bus_write(i2c, ADDR, buf, 2);
 }
 
 // função intermediária que calcula a temperatura de resolução fina
 // usada tanto para conversões de pressão quanto de temperatura
-int32_t bmp280_convert(int32_t temp, struct bmp280_calib_param* params) {
+int32_t bmp280_convert(int32_t temp, const struct bmp280_calib_param* params) {
     // usa os 32 bits de compensação de ponto fixo implementados no datasheet
     int32_t var1, var2;
     var1 = ((((temp >> 3) - ((int32_t)params->dig_t1 << 1))) * ((int32_t)params->dig_t2)) >> 11;
@@ -52,11 +89,8 @@ int32_t bmp280_convert_temp(int32_t temp, struct bmp280_calib_param* params) {
 }
 
 
-int32_t bmp280_convert_pressure(int32_t pressure, int32_t temp, struct bmp280_calib_param* params) {
-    // Utiliza os parâmetros de calibração do BMP280 para compensar o valor de pressão lido de seus registradores
-
-    int32_t t_fine = bmp280_convert(temp, params);
-
+// Pressão em Pa com a rotina de 32 bits do datasheet
+static uint32_t bmp280_pressure32(int32_t pressure, int32_t t_fine, const struct bmp280_calib_param* params) {
     int32_t var1, var2;
     uint32_t converted = 0.0;
     var1 = (((int32_t)t_fine) >> 1) - (int32_t)64000;
@@ -80,11 +114,61 @@ int32_t bmp280_convert_pressure(int32_t pressure, int32_t temp, struct bmp280_ca
     return converted;
 }
 
+#if BMP280_PRESSURE_64BIT
+// Pressão em Pa × 256 com a rotina de 64 bits do datasheet
+// (deslocamentos à esquerda de valores com sinal viram multiplicações)
+static uint32_t bmp280_pressure64(int32_t pressure, int32_t t_fine, const struct bmp280_calib_param* params) {
+    int64_t var1, var2, p;
+    var1 = (int64_t)t_fine - 128000;
+    var2 = var1 * var1 * (int64_t)params->dig_p6;
+    var2 = var2 + var1 * (int64_t)params->dig_p5 * ((int64_t)1 << 17);
+    var2 = var2 + (int64_t)params->dig_p4 * ((int64_t)1 << 35);
+    var1 = ((var1 * var1 * (int64_t)params->dig_p3) >> 8) + var1 * (int64_t)params->dig_p2 * ((int64_t)1 << 12);
+    var1 = ((((int64_t)1 << 47) + var1) * (int64_t)params->dig_p1) >> 33;
+    if (var1 == 0) {
+        return 0;  // avoid exception caused by division by zero
+    }
+    p = 1048576 - pressure;
+    p = (((p << 31) - var2) * 3125) / var1;
+    var1 = ((int64_t)params->dig_p9 * (p >> 13) * (p >> 13)) >> 25;
+    var2 = ((int64_t)params->dig_p8 * p) >> 19;
+    p = ((p + var1 + var2) >> 8) + (int64_t)params->dig_p7 * 16;
+    return (uint32_t)p;
+}
+#endif
+
+int32_t bmp280_convert_pressure(int32_t pressure, int32_t temp, struct bmp280_calib_param* params) {
+    // Utiliza os parâmetros de calibração do BMP280 para compensar o valor de pressão lido de seus registradores
+    return (int32_t)bmp280_pressure32(pressure, bmp280_convert(temp, params), params);
+}
+
+// Leitura bruta de um canal com osrs = SKIP
+#define BMP280_RAW_SKIPPED 0x80000
+
+bool bmp280_compensate(int32_t temp, int32_t pressure, const struct bmp280_calib_param* params,
+                       bmp280_measurement_t* out) {
+    if (temp == BMP280_RAW_SKIPPED) return false;
+
+    // t_fine é a base das duas compensações: calculado uma única vez
+    int32_t t_fine = bmp280_convert(temp, params);
+    out->temp_cdeg = (t_fine * 5 + 128) >> 8;
+
+    if (pressure == BMP280_RAW_SKIPPED) {
+        out->pressure_q8 = 0;
+    } else {
+#if BMP280_PRESSURE_64BIT
+        out->pressure_q8 = bmp280_pressure64(pressure, t_fine, params);
+#else
+        out->pressure_q8 = bmp280_pressure32(pressure, t_fine, params) << 8;
+#endif
+    }
+    return true;
+}
+
 void bmp280_get_calib_params(i2c_inst_t *i2c, struct bmp280_calib_param* params) {
     uint8_t buf[NUM_CALIB_PARAMS] = { 0 };
     uint8_t reg = REG_DIG_T1_LSB;
-    i2c_write_blocking(i2c, ADDR, &reg, 1, true);
-    i2c_read_blocking(i2c, ADDR, buf, NUM_CALIB_PARAMS, false);
+    i2c_bus_write_read(i2c, ADDR, &reg, 1, buf, NUM_CALIB_PARAMS);
 
     params->dig_t1 = (uint16_t)(buf[1] << 8) | buf[0];
     params->dig_t2 = (int16_t)(buf[3] << 8) | buf[2];
@@ -8,6 +8,7 @@
 
 #define REG_CONFIG _u(0xF5)
 #define REG_CTRL_MEAS _u(0xF4)
+#define REG_STATUS _u(0xF3)
 #define REG_RESET _u(0xE0)
 
 #define REG_TEMP_XLSB _u(0xFC)
@@ -61,12 +62,99 @@ struct bmp280_calib_param {
     int16_t dig_p9;
 };
 
+// Compensação de pressão com a rotina de 64 bits do datasheet: resolução de
+// 1/256 Pa em vez de 1 Pa, ao custo de aritmética de 64 bits (sem hardware
+// no M0+). Definir com target_compile_definitions na biblioteca bmp280.
+#ifndef BMP280_PRESSURE_64BIT
+#define BMP280_PRESSURE_64BIT 0
+#endif
+
+// Modo de operação (bits 1-0 de ctrl_meas)
+typedef enum {
+    BMP280_MODE_SLEEP = 0,
+    BMP280_MODE_FORCED = 1,   // Uma medição por bmp280_trigger(), depois volta a dormir
+    BMP280_MODE_NORMAL = 3,   // Medições contínuas separadas por 'standby'
+} bmp280_mode_t;
+
+// Sobreamostragem de temperatura/pressão (osrs_t, osrs_p)
+typedef enum {
+    BMP280_OSRS_SKIP = 0,     // Canal desligado (leitura bruta 0x80000)
+    BMP280_OSRS_X1,
+    BMP280_OSRS_X2,
+    BMP280_OSRS_X4,
+    BMP280_OSRS_X8,
+    BMP280_OSRS_X16,
+} bmp280_osrs_t;
+
+// Coeficiente do filtro IIR (bits 4-2 de config)
+typedef enum {
+    BMP280_FILTER_OFF = 0,
+    BMP280_FILTER_2,
+    BMP280_FILTER_4,
+    BMP280_FILTER_8,
+    BMP280_FILTER_16,
+} bmp280_filter_t;
+
+// Espera entre medições no modo normal (bits 7-5 de config)
+typedef enum {
+    BMP280_STANDBY_0_5_MS = 0,
+    BMP280_STANDBY_62_5_MS,
+    BMP280_STANDBY_125_MS,
+    BMP280_STANDBY_250_MS,
+    BMP280_STANDBY_500_MS,
+    BMP280_STANDBY_1000_MS,
+    BMP280_STANDBY_2000_MS,
+    BMP280_STANDBY_4000_MS,
+} bmp280_standby_t;
+
+typedef struct {
+    bmp280_mode_t mode;
+    bmp280_osrs_t osrs_t;
+    bmp280_osrs_t osrs_p;
+    bmp280_filter_t filter;
+    bmp280_standby_t standby;
+} bmp280_config_t;
+
+// Configuração aplicada por bmp280_init(): normal, T x1, P x4, IIR 16, 500 ms
+#define BMP280_CONFIG_DEFAULT {             \
+    .mode = BMP280_MODE_NORMAL,             \
+    .osrs_t = BMP280_OSRS_X1,               \
+    .osrs_p = BMP280_OSRS_X4,               \
+    .filter = BMP280_FILTER_16,             \
+    .standby = BMP280_STANDBY_500_MS,       \
+}
+
+// Temperatura e pressão compensadas a partir de um único t_fine
+typedef struct {
+    int32_t temp_cdeg;        // 0,01 °C
+    uint32_t pressure_q8;     // Pa × 256 (Q24.8); fração zerada sem BMP280_PRESSURE_64BIT
+} bmp280_measurement_t;
+
 //void bmp280_init(void);
 void bmp280_init(i2c_inst_t *i2c);
+
+// Aplica modo, sobreamostragem, filtro e standby (config antes de ctrl_meas)
+void bmp280_configure(i2c_inst_t *i2c, const bmp280_config_t *cfg);
+
+// Modo forçado: dispara uma medição com a sobreamostragem de 'cfg'
+void bmp280_trigger(i2c_inst_t *i2c, const bmp280_config_t *cfg);
+
+// Bit 'measuring' do status: conversão em andamento
+bool bmp280_is_measuring(i2c_inst_t *i2c);
+
+// Duração máxima de uma medição com essa sobreamostragem (datasheet, tabela 13)
+uint32_t bmp280_measure_time_us(const bmp280_config_t *cfg);
+
 void bmp280_read_raw(i2c_inst_t *i2c, int32_t* temp, int32_t* pressure);
 void bmp280_reset(i2c_inst_t *i2c);
 int32_t bmp280_convert_temp(int32_t temp, struct bmp280_calib_param* params);
 int32_t bmp280_convert_pressure(int32_t pressure, int32_t temp, struct bmp280_calib_param* params);
+
+// Compensa temperatura e pressão calculando t_fine uma vez. Retorna false se
+// a temperatura não foi medida; pressão não medida sai como zero.
+bool bmp280_compensate(int32_t temp, int32_t pressure, const struct bmp280_calib_param* params,
+                       bmp280_measurement_t* out);
+
 void bmp280_get_calib_params(i2c_inst_t *i2c, struct bmp280_calib_param* params);
 
 #endif
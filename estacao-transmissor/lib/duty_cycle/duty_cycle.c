@@ -0,0 +1,66 @@
+#include "duty_cycle.h"
+#include <string.h>
+
+#define NUM_SLOTS (DUTY_CYCLE_BUCKETS + 1)
+
+void duty_cycle_init(duty_cycle_t *dc, uint32_t window_ms, uint16_t duty_permille, uint32_t now_ms) {
+    memset(dc, 0, sizeof(*dc));
+    dc->window_ms = window_ms;
+    dc->budget_ms = (uint32_t)(((uint64_t)window_ms * duty_permille) / 1000u);
+    dc->bucket_ms = window_ms / DUTY_CYCLE_BUCKETS;
+    if (dc->bucket_ms == 0) dc->bucket_ms = 1;
+    dc->bucket_start_ms = now_ms;
+}
+
+// Avança a janela até a fatia que contém 'now_ms', liberando as que saíram
+static void duty_cycle_advance(duty_cycle_t *dc, uint32_t now_ms) {
+    uint32_t elapsed = now_ms - dc->bucket_start_ms;
+    if (elapsed < dc->bucket_ms) return;
+
+    uint32_t steps = elapsed / dc->bucket_ms;
+    if (steps >= NUM_SLOTS) {
+        // Ficou ocioso mais que uma janela: tudo expirou
+        memset(dc->used_ms, 0, sizeof(dc->used_ms));
+        dc->used_total_ms = 0;
+    } else {
+        for (uint32_t i = 0; i < steps; i++) {
+            dc->head = (uint8_t)((dc->head + 1) % NUM_SLOTS);
+            dc->used_total_ms -= dc->used_ms[dc->head];
+            dc->used_ms[dc->head] = 0;
+        }
+    }
+    dc->bucket_start_ms += steps * dc->bucket_ms;
+}
+
+uint32_t duty_cycle_remaining_ms(duty_cycle_t *dc, uint32_t now_ms) {
+    duty_cycle_advance(dc, now_ms);
+    return dc->used_total_ms >= dc->budget_ms ? 0 : dc->budget_ms - dc->used_total_ms;
+}
+
+uint32_t duty_cycle_wait_ms(duty_cycle_t *dc, uint32_t now_ms, uint32_t airtime_ms) {
+    if (airtime_ms > dc->budget_ms) return UINT32_MAX;
+
+    uint32_t remaining = duty_cycle_remaining_ms(dc, now_ms);
+    if (airtime_ms <= remaining) return 0;
+
+    // Percorre as fatias da mais antiga para a mais nova: a fatia com idade
+    // 'age' sai da janela em bucket_start + (NUM_SLOTS - age) * bucket_ms
+    uint32_t need = airtime_ms - remaining;
+    uint32_t freed = 0;
+    for (uint32_t age = NUM_SLOTS - 1; age > 0; age--) {
+        uint8_t idx = (uint8_t)((dc->head + NUM_SLOTS - age) % NUM_SLOTS);
+        freed += dc->used_ms[idx];
+        if (freed >= need) {
+            uint32_t expiry = dc->bucket_start_ms + (NUM_SLOTS - age) * dc->bucket_ms;
+            return expiry - now_ms;
+        }
+    }
+    // Só resta a fatia atual: libera quando ela também sair da janela
+    return dc->bucket_start_ms + NUM_SLOTS * dc->bucket_ms - now_ms;
+}
+
+void duty_cycle_record(duty_cycle_t *dc, uint32_t now_ms, uint32_t airtime_ms) {
+    duty_cycle_advance(dc, now_ms);
+    dc->used_ms[dc->head] += airtime_ms;
+    dc->used_total_ms += airtime_ms;
+}
@@ -0,0 +1,38 @@
+#ifndef DUTY_CYCLE_H
+#define DUTY_CYCLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Limite de ocupação do canal (duty cycle) sobre uma janela deslizante.
+// Não depende do SDK nem do FreeRTOS: o tempo atual é sempre passado pelo
+// chamador, o que permite testar com relógio simulado no host.
+
+// Número de fatias da janela. O tempo no ar de cada fatia só é liberado
+// depois que a fatia inteira sai da janela (arredonda a favor da norma).
+#define DUTY_CYCLE_BUCKETS 24
+
+typedef struct {
+    uint32_t window_ms;                         // Tamanho da janela deslizante
+    uint32_t budget_ms;                         // Tempo no ar permitido por janela
+    uint32_t bucket_ms;                         // Duração de cada fatia
+    uint32_t bucket_start_ms;                   // Início da fatia atual
+    uint8_t head;                               // Índice da fatia atual
+    uint32_t used_ms[DUTY_CYCLE_BUCKETS + 1];   // Tempo no ar registrado por fatia
+    uint32_t used_total_ms;                     // Soma de used_ms
+} duty_cycle_t;
+
+// duty_permille: 10 = 1%, 100 = 10%
+void duty_cycle_init(duty_cycle_t *dc, uint32_t window_ms, uint16_t duty_permille, uint32_t now_ms);
+
+// Tempo no ar ainda disponível na janela atual
+uint32_t duty_cycle_remaining_ms(duty_cycle_t *dc, uint32_t now_ms);
+
+// Quanto esperar até poder transmitir 'airtime_ms'. 0 = pode transmitir já;
+// UINT32_MAX = o quadro é maior que o orçamento da janela inteira.
+uint32_t duty_cycle_wait_ms(duty_cycle_t *dc, uint32_t now_ms, uint32_t airtime_ms);
+
+// Registra uma transmissão concluída
+void duty_cycle_record(duty_cycle_t *dc, uint32_t now_ms, uint32_t airtime_ms);
+
+#endif
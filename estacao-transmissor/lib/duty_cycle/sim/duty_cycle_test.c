@@ -0,0 +1,196 @@
+// duty_cycle_test.c — teste no host do tempo no ar (sx127x_airtime.c) e do
+// limite de ocupação do canal (duty_cycle.c), com relógio simulado.
+//
+// Compilar e rodar (Linux):
+//   gcc -O2 -I.. -I../../sx127x -o duty_cycle_test duty_cycle_test.c ../duty_cycle.c ../../sx127x/sx127x_airtime.c
+//   ./duty_cycle_test
+//
+// Os tempos no ar esperados são os da calculadora LoRa da Semtech (fórmula
+// da AN1200.13 / datasheet do SX1276, seção 4.1.1.7) para cada combinação.
+// Sai com código 1 se algum teste falhar.
+
+#include <stdio.h>
+#include "duty_cycle.h"
+#include "sx127x.h"
+
+static int failures = 0;
+
+#define CHECK_EQ(got, want) do {                                                   \
+        unsigned long long g_ = (unsigned long long)(got);                         \
+        unsigned long long w_ = (unsigned long long)(want);                        \
+        if (g_ != w_) {                                                            \
+            printf("FALHOU %s:%d: %s = %llu, esperado %llu\n",                      \
+                   __FILE__, __LINE__, #got, g_, w_);                              \
+            failures++;                                                            \
+        }                                                                          \
+    } while (0)
+
+// === Tempo no ar ===
+
+typedef struct {
+    uint8_t sf;
+    sx127x_bw_t bw;
+    uint8_t cr;               // 1..4 = 4/5..4/8
+    bool crc_on;
+    bool implicit_header;
+    sx127x_ldro_t ldro;
+    uint8_t payload_len;
+    uint32_t expected_us;
+} airtime_case_t;
+
+static const airtime_case_t airtime_cases[] = {
+    // Quadro de leitura (12 B) com o perfil padrão, nos extremos de SF
+    { 7,  SX127X_BW_125K, 1, true,  false, SX127X_LDRO_AUTO, 12,    41216 },
+    { 12, SX127X_BW_125K, 1, true,  false, SX127X_LDRO_AUTO, 12,  1155072 },   // LDRO automático
+    // LDRO: SF12 sem otimização fica mais curto (e fora da norma do chip)
+    { 12, SX127X_BW_125K, 1, true,  false, SX127X_LDRO_OFF,  12,   991232 },
+    // SF11: símbolo de 16,384 ms em 125 kHz (LDRO automático ligado), 8,192 ms em 250 kHz
+    { 11, SX127X_BW_125K, 1, true,  false, SX127X_LDRO_AUTO, 12,   577536 },
+    { 11, SX127X_BW_250K, 1, true,  false, SX127X_LDRO_AUTO, 12,   288768 },
+    // CR 4/8
+    { 7,  SX127X_BW_125K, 4, true,  false, SX127X_LDRO_AUTO, 51,   151808 },
+    // Header implícito contra explícito, CR 4/8
+    { 9,  SX127X_BW_125K, 4, true,  true,  SX127X_LDRO_AUTO, 10,   148480 },
+    { 9,  SX127X_BW_125K, 4, true,  false, SX127X_LDRO_AUTO, 10,   181248 },
+    // Sem CRC e payload pequeno: só os 8 símbolos mínimos
+    { 12, SX127X_BW_125K, 1, false, true,  SX127X_LDRO_AUTO, 1,    663552 },
+    // Payload máximo em SF12
+    { 12, SX127X_BW_125K, 1, true,  false, SX127X_LDRO_AUTO, 255, 9019392 },
+    // 500 kHz
+    { 7,  SX127X_BW_500K, 1, true,  false, SX127X_LDRO_AUTO, 12,    10304 },
+};
+
+static void test_airtime(void) {
+    for (size_t i = 0; i < sizeof(airtime_cases) / sizeof(airtime_cases[0]); i++) {
+        const airtime_case_t *c = &airtime_cases[i];
+        sx127x_profile_t p = SX127X_PROFILE_DEFAULT;
+        p.sf = c->sf;
+        p.bw = c->bw;
+        p.cr = c->cr;
+        p.crc_on = c->crc_on;
+        p.implicit_header = c->implicit_header;
+        p.ldro = c->ldro;
+        p.preamble_len = 8;
+        uint32_t got = sx127x_time_on_air_us(&p, c->payload_len);
+        if (got != c->expected_us) {
+            printf("FALHOU tempo no ar caso %zu (SF%u, %u B): %lu us, esperado %lu us\n",
+                   i, c->sf, c->payload_len, (unsigned long)got, (unsigned long)c->expected_us);
+            failures++;
+        }
+    }
+
+    // Limite de 16 ms do LDRO automático
+    sx127x_profile_t p = SX127X_PROFILE_DEFAULT;
+    p.sf = 11;
+    CHECK_EQ(sx127x_ldro_enabled(&p), true);
+    p.sf = 10;
+    CHECK_EQ(sx127x_ldro_enabled(&p), false);
+    p.sf = 12;
+    p.bw = SX127X_BW_500K;
+    CHECK_EQ(sx127x_ldro_enabled(&p), false);
+
+    // Parâmetros inválidos
+    p.sf = 13;
+    CHECK_EQ(sx127x_time_on_air_us(&p, 12), 0);
+}
+
+// === Duty cycle: 1% de 1 h, fatias de 150 s ===
+
+#define WINDOW_MS  3600000u
+#define PERMILLE   10
+#define BUDGET_MS  36000u
+#define BUCKET_MS  (WINDOW_MS / DUTY_CYCLE_BUCKETS)
+#define RELEASE_MS ((DUTY_CYCLE_BUCKETS + 1) * BUCKET_MS)   // Fatia sai da janela
+
+static void test_budget(uint32_t t0) {
+    duty_cycle_t dc;
+    duty_cycle_init(&dc, WINDOW_MS, PERMILLE, t0);
+    CHECK_EQ(dc.budget_ms, BUDGET_MS);
+    CHECK_EQ(duty_cycle_remaining_ms(&dc, t0), BUDGET_MS);
+
+    // Quadro maior que o orçamento inteiro nunca passa; igual passa
+    CHECK_EQ(duty_cycle_wait_ms(&dc, t0, BUDGET_MS + 1), UINT32_MAX);
+    CHECK_EQ(duty_cycle_wait_ms(&dc, t0, BUDGET_MS), 0);
+
+    // Orçamento esgotado na primeira fatia: libera quando ela sai da janela
+    duty_cycle_record(&dc, t0, BUDGET_MS);
+    CHECK_EQ(duty_cycle_remaining_ms(&dc, t0), 0);
+    CHECK_EQ(duty_cycle_wait_ms(&dc, t0, 41), RELEASE_MS);
+    CHECK_EQ(duty_cycle_wait_ms(&dc, t0 + 1000, 41), RELEASE_MS - 1000);
+    CHECK_EQ(duty_cycle_remaining_ms(&dc, t0 + RELEASE_MS - 1), 0);
+    CHECK_EQ(duty_cycle_remaining_ms(&dc, t0 + RELEASE_MS), BUDGET_MS);
+    CHECK_EQ(duty_cycle_wait_ms(&dc, t0 + RELEASE_MS, 41), 0);
+}
+
+static void test_buckets(uint32_t t0) {
+    duty_cycle_t dc;
+    duty_cycle_init(&dc, WINDOW_MS, PERMILLE, t0);
+
+    // Último ms da fatia 0 e primeiro da fatia 1
+    duty_cycle_record(&dc, t0 + BUCKET_MS - 1, 20000);
+    duty_cycle_record(&dc, t0 + BUCKET_MS, 16000);
+    CHECK_EQ(duty_cycle_remaining_ms(&dc, t0 + BUCKET_MS), 0);
+
+    // 5 s só voltam com a saída da fatia 0; 30 s exigem as duas
+    uint32_t now = t0 + 5 * BUCKET_MS + 123;
+    CHECK_EQ(duty_cycle_wait_ms(&dc, now, 5000), t0 + RELEASE_MS - now);
+    CHECK_EQ(duty_cycle_wait_ms(&dc, now, 30000), t0 + RELEASE_MS + BUCKET_MS - now);
+
+    CHECK_EQ(duty_cycle_remaining_ms(&dc, t0 + RELEASE_MS - 1), 0);
+    CHECK_EQ(duty_cycle_remaining_ms(&dc, t0 + RELEASE_MS), 20000);
+    CHECK_EQ(duty_cycle_remaining_ms(&dc, t0 + RELEASE_MS + BUCKET_MS - 1), 20000);
+    CHECK_EQ(duty_cycle_remaining_ms(&dc, t0 + RELEASE_MS + BUCKET_MS), BUDGET_MS);
+}
+
+static void test_idle(uint32_t t0) {
+    duty_cycle_t dc;
+    duty_cycle_init(&dc, WINDOW_MS, PERMILLE, t0);
+    duty_cycle_record(&dc, t0, 30000);
+
+    // Mais de uma janela ociosa: tudo expira de uma vez e a contagem segue certa
+    uint32_t t1 = t0 + 3 * WINDOW_MS + 77;
+    CHECK_EQ(duty_cycle_remaining_ms(&dc, t1), BUDGET_MS);
+    duty_cycle_record(&dc, t1, BUDGET_MS);
+    CHECK_EQ(duty_cycle_remaining_ms(&dc, t1), 0);
+    uint32_t start = t1 - 77;   // Fatias continuam alinhadas a t0
+    CHECK_EQ(duty_cycle_wait_ms(&dc, t1, 1), start + RELEASE_MS - t1);
+    CHECK_EQ(duty_cycle_remaining_ms(&dc, start + RELEASE_MS), BUDGET_MS);
+}
+
+// Muitos quadros pequenos: nunca mais que o orçamento em janela nenhuma
+static void test_sliding(uint32_t t0) {
+    duty_cycle_t dc;
+    duty_cycle_init(&dc, WINDOW_MS, PERMILLE, t0);
+    static uint32_t sent_at[4096];
+    uint32_t sent = 0;
+    for (uint32_t t = 0; t < 3 * WINDOW_MS && sent < 4096; t += 1000) {
+        if (duty_cycle_wait_ms(&dc, t0 + t, 41) == 0) {
+            duty_cycle_record(&dc, t0 + t, 41);
+            sent_at[sent++] = t;
+        }
+    }
+    uint32_t max_in_window = 0;
+    for (uint32_t i = 0, j = 0; i < sent; i++) {
+        while (sent_at[i] - sent_at[j] >= WINDOW_MS) j++;
+        if (i - j + 1 > max_in_window) max_in_window = i - j + 1;
+    }
+    CHECK_EQ(max_in_window <= BUDGET_MS / 41, true);
+    CHECK_EQ(max_in_window, BUDGET_MS / 41);
+}
+
+int main(void) {
+    test_airtime();
+
+    // Com o relógio longe e perto da volta do uint32 em ms (~49,7 dias)
+    const uint32_t origins[] = { 0, 123456, UINT32_MAX - 1000, UINT32_MAX - BUCKET_MS / 2,
+                                 UINT32_MAX - WINDOW_MS };
+    for (size_t i = 0; i < sizeof(origins) / sizeof(origins[0]); i++) {
+        test_budget(origins[i]);
+        test_buckets(origins[i]);
+        test_idle(origins[i]);
+        test_sliding(origins[i]);
+    }
+
+    printf("%s (%d falhas)\n", failures ? "FALHOU" : "ok", failures);
+    return failures ? 1 : 0;
+}
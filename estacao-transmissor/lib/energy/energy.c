@@ -0,0 +1,92 @@
+#include "energy.h"
+#include <string.h>
+
+static const uint32_t radio_ua[ENERGY_RADIO_STATES] = {
+    [ENERGY_RADIO_SLEEP] = ENERGY_SX127X_SLEEP_UA,
+    [ENERGY_RADIO_STANDBY] = ENERGY_SX127X_STANDBY_UA,
+    [ENERGY_RADIO_RX] = ENERGY_SX127X_RX_UA,
+    [ENERGY_RADIO_CAD] = ENERGY_SX127X_RX_UA,
+    [ENERGY_RADIO_TX] = 0,                  // Ver tx_charge_nc
+};
+
+// Curva típica do PA_BOOST: 87 mA em 17 dBm e 120 mA em 20 dBm (datasheet);
+// abaixo disso, valores medidos em módulos comuns
+static const struct {
+    int8_t dbm;
+    uint32_t ua;
+} tx_curve[] = {
+    { 2, 28000 }, { 10, 40000 }, { 14, 55000 }, { 17, 87000 }, { 20, 120000 },
+};
+
+#define TX_CURVE_LEN (sizeof(tx_curve) / sizeof(tx_curve[0]))
+
+uint32_t energy_tx_current_ua(int8_t dbm) {
+    if (dbm <= tx_curve[0].dbm) return tx_curve[0].ua;
+    for (unsigned i = 1; i < TX_CURVE_LEN; i++) {
+        if (dbm <= tx_curve[i].dbm) {
+            int32_t span = tx_curve[i].dbm - tx_curve[i - 1].dbm;
+            int32_t step = (int32_t)(tx_curve[i].ua - tx_curve[i - 1].ua);
+            return tx_curve[i - 1].ua + (uint32_t)(step * (dbm - tx_curve[i - 1].dbm) / span);
+        }
+    }
+    return tx_curve[TX_CURVE_LEN - 1].ua;
+}
+
+void energy_init(energy_t *e, energy_radio_state_t state, uint64_t now_us) {
+    memset(e, 0, sizeof(*e));
+    e->radio_state = (uint8_t)state;
+    e->radio_since_us = now_us;
+    e->cycle_start_us = now_us;
+}
+
+// Contabiliza o estado atual até 'now_us'
+static void energy_account(energy_t *e, uint64_t now_us) {
+    uint64_t dt = now_us - e->radio_since_us;
+    e->radio_us[e->radio_state] += dt;
+    if (e->radio_state == ENERGY_RADIO_TX) {
+        // uA × us = pC; guardado em nC
+        e->tx_charge_nc += dt * energy_tx_current_ua(e->tx_power_dbm) / 1000;
+    }
+    e->radio_since_us = now_us;
+}
+
+void energy_radio(energy_t *e, energy_radio_state_t state, int8_t tx_power_dbm, uint64_t now_us) {
+    energy_account(e, now_us);
+    e->radio_state = (uint8_t)state;
+    if (state == ENERGY_RADIO_TX) e->tx_power_dbm = tx_power_dbm;
+}
+
+void energy_mcu_idle(energy_t *e, uint64_t idle_us) {
+    e->mcu_idle_us += idle_us;
+}
+
+void energy_cycle(energy_t *e, uint64_t now_us, energy_report_t *out) {
+    energy_account(e, now_us);
+
+    uint64_t period = now_us - e->cycle_start_us;
+    uint64_t idle = e->mcu_idle_us < period ? e->mcu_idle_us : period;
+
+    uint64_t radio_nc = e->tx_charge_nc;
+    for (int s = 0; s < ENERGY_RADIO_STATES; s++) {
+        radio_nc += e->radio_us[s] * radio_ua[s] / 1000;
+        out->radio_ms[s] = (uint32_t)(e->radio_us[s] / 1000);
+    }
+    uint64_t mcu_nc = ((period - idle) * ENERGY_MCU_RUN_UA + idle * ENERGY_MCU_IDLE_UA) / 1000;
+
+    out->period_ms = (uint32_t)(period / 1000);
+    out->mcu_idle_ms = (uint32_t)(idle / 1000);
+    out->radio_uc = (uint32_t)(radio_nc / 1000);
+    out->mcu_uc = (uint32_t)(mcu_nc / 1000);
+    // nC / us = mA: ×1000 para uA
+    out->avg_ua = period ? (uint32_t)((radio_nc + mcu_nc) * 1000 / period) : 0;
+
+    memset(e->radio_us, 0, sizeof(e->radio_us));
+    e->tx_charge_nc = 0;
+    e->mcu_idle_us = 0;
+    e->cycle_start_us = now_us;
+}
+
+uint32_t energy_battery_hours(const energy_report_t *r, uint32_t capacity_mah) {
+    if (r->avg_ua == 0) return UINT32_MAX;
+    return (uint32_t)((uint64_t)capacity_mah * 1000 / r->avg_ua);
+}
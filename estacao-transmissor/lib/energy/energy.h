@@ -0,0 +1,63 @@
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include <stdint.h>
+
+// Estimativa do consumo por ciclo a partir do tempo em cada estado do rádio
+// e do tempo que o MCU passou dormindo (tickless idle). As correntes são
+// valores típicos de datasheet (SX1276 na banda HF, RP2040 a 125 MHz), não
+// medidas: servem para comparar configurações e estimar a autonomia.
+// Sem dependência do SDK: o tempo (us) é passado pelo chamador.
+
+#define ENERGY_SX127X_SLEEP_UA      1       // 0,2 uA típico, 1 uA máximo
+#define ENERGY_SX127X_STANDBY_UA    1600
+#define ENERGY_SX127X_RX_UA         12000   // LnaBoost ligado; CAD consome o mesmo
+#define ENERGY_MCU_RUN_UA           25000
+#define ENERGY_MCU_IDLE_UA          9000    // WFI com clocks ligados
+
+typedef enum {
+    ENERGY_RADIO_SLEEP = 0,
+    ENERGY_RADIO_STANDBY,
+    ENERGY_RADIO_RX,
+    ENERGY_RADIO_CAD,
+    ENERGY_RADIO_TX,
+    ENERGY_RADIO_STATES,
+} energy_radio_state_t;
+
+typedef struct {
+    uint8_t radio_state;
+    int8_t tx_power_dbm;                    // Potência das transmissões em curso
+    uint64_t radio_since_us;                // Entrada no estado atual
+    uint64_t cycle_start_us;
+    uint64_t radio_us[ENERGY_RADIO_STATES]; // Tempo por estado no ciclo
+    uint64_t tx_charge_nc;                  // Carga das transmissões (depende da potência)
+    uint64_t mcu_idle_us;                   // Tempo dormindo no ciclo
+} energy_t;
+
+typedef struct {
+    uint32_t period_ms;                     // Duração do ciclo
+    uint32_t radio_ms[ENERGY_RADIO_STATES];
+    uint32_t mcu_idle_ms;
+    uint32_t radio_uc;                      // Carga do rádio no ciclo (uC)
+    uint32_t mcu_uc;                        // Carga do MCU no ciclo (uC)
+    uint32_t avg_ua;                        // Corrente média do ciclo
+} energy_report_t;
+
+void energy_init(energy_t *e, energy_radio_state_t state, uint64_t now_us);
+
+// Corrente de TX no PA_BOOST para a potência (interpolação da curva típica)
+uint32_t energy_tx_current_ua(int8_t tx_power_dbm);
+
+// Registra a troca de estado do rádio ('tx_power_dbm' só vale para TX)
+void energy_radio(energy_t *e, energy_radio_state_t state, int8_t tx_power_dbm, uint64_t now_us);
+
+// Soma um período em que o MCU dormiu
+void energy_mcu_idle(energy_t *e, uint64_t idle_us);
+
+// Fecha o ciclo iniciado no último relatório e começa outro
+void energy_cycle(energy_t *e, uint64_t now_us, energy_report_t *out);
+
+// Autonomia (h) de uma bateria de 'capacity_mah' na corrente média do relatório
+uint32_t energy_battery_hours(const energy_report_t *r, uint32_t capacity_mah);
+
+#endif
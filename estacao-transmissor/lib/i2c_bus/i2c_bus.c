@@ -0,0 +1,196 @@
+#include "i2c_bus.h"
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#define I2C_BUS_COUNT 2
+
+// Nível do FIFO de TX abaixo do qual o I2C pede mais palavras ao DMA
+#define I2C_BUS_TX_DMA_LEVEL 8
+
+typedef struct {
+    bool ready;
+    SemaphoreHandle_t mutex;
+    int dma_tx;
+    int dma_rx;
+    uint32_t baudrate;
+    TaskHandle_t waiter;
+    volatile uint32_t abort_source;
+    // Palavras de IC_DATA_CMD: dado (7-0) | leitura (8) | STOP (9) | RESTART (10)
+    uint16_t cmd[I2C_BUS_MAX_LEN];
+} i2c_bus_t;
+
+static i2c_bus_t buses[I2C_BUS_COUNT];
+
+// === Interrupção do controlador: fim da transferência (STOP) ===
+// Um abort (NACK, perda de arbitragem) também termina em STOP; a causa
+// fica em abort_source para a task. O abort não é limpo aqui: limpar libera
+// o FIFO de TX e o DMA, ainda ativo, começaria uma transação parcial. A task
+// para o DMA primeiro e só então limpa.
+static void i2c_bus_irq(i2c_bus_t *bus, i2c_hw_t *hw) {
+    uint32_t stat = hw->intr_stat;
+    if (stat & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        bus->abort_source = hw->tx_abrt_source;
+        hw->intr_mask &= ~I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+    }
+    if ((stat & I2C_IC_INTR_STAT_R_STOP_DET_BITS) == 0) return;
+    (void)hw->clr_stop_det;
+    hw->intr_mask = 0;
+
+    BaseType_t woken = pdFALSE;
+    if (bus->waiter) vTaskNotifyGiveIndexedFromISR(bus->waiter, I2C_BUS_NOTIFY_INDEX, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static void i2c_bus_irq0(void) {
+    i2c_bus_irq(&buses[0], i2c_get_hw(i2c0));
+}
+
+static void i2c_bus_irq1(void) {
+    i2c_bus_irq(&buses[1], i2c_get_hw(i2c1));
+}
+
+bool i2c_bus_init(i2c_inst_t *i2c, uint32_t baudrate, unsigned int sda, unsigned int scl) {
+    i2c_bus_t *bus = &buses[i2c_hw_index(i2c)];
+    bool ok = true;
+
+    // Duas tasks no mesmo barramento: só a primeira configura
+    vTaskSuspendAll();
+    if (!bus->ready) {
+        bus->mutex = xSemaphoreCreateMutex();
+        ok = bus->mutex != NULL;
+    }
+    if (ok && !bus->ready) {
+        bus->baudrate = i2c_init(i2c, baudrate);
+        gpio_set_function(sda, GPIO_FUNC_I2C);
+        gpio_set_function(scl, GPIO_FUNC_I2C);
+        gpio_pull_up(sda);
+        gpio_pull_up(scl);
+
+        bus->dma_tx = dma_claim_unused_channel(true);
+        bus->dma_rx = dma_claim_unused_channel(true);
+
+        i2c_hw_t *hw = i2c_get_hw(i2c);
+        hw->intr_mask = 0;
+        hw->dma_tdlr = I2C_BUS_TX_DMA_LEVEL;
+        hw->dma_rdlr = 0;                              // Pede DMA a cada byte recebido
+        hw->dma_cr = I2C_IC_DMA_CR_TDMAE_BITS | I2C_IC_DMA_CR_RDMAE_BITS;
+
+        unsigned int irq = i2c_hw_index(i2c) ? I2C1_IRQ : I2C0_IRQ;
+        irq_set_exclusive_handler(irq, i2c_hw_index(i2c) ? i2c_bus_irq1 : i2c_bus_irq0);
+        irq_set_enabled(irq, true);
+        bus->ready = true;
+    }
+    xTaskResumeAll();
+    return ok;
+}
+
+// === Transferência por DMA: a task dorme até o STOP ===
+// Chamada com o mutex do barramento em mãos.
+static int i2c_bus_dma(i2c_bus_t *bus, i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t wlen,
+                       uint8_t *dst, size_t rlen) {
+    i2c_hw_t *hw = i2c_get_hw(i2c);
+    size_t total = wlen + rlen;
+
+    for (size_t i = 0; i < wlen; i++) {
+        bus->cmd[i] = src[i];
+    }
+    for (size_t i = 0; i < rlen; i++) {
+        bus->cmd[wlen + i] = I2C_IC_DATA_CMD_CMD_BITS | (i == 0 && wlen ? I2C_IC_DATA_CMD_RESTART_BITS : 0);
+    }
+    bus->cmd[total - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+    // Endereço do escravo só muda com o controlador desabilitado
+    hw->enable = 0;
+    hw->tar = addr;
+    hw->enable = 1;
+    (void)hw->clr_stop_det;
+    (void)hw->clr_tx_abrt;
+    bus->abort_source = 0;
+    bus->waiter = xTaskGetCurrentTaskHandle();
+    ulTaskNotifyTakeIndexed(I2C_BUS_NOTIFY_INDEX, pdTRUE, 0);   // Descarta aviso antigo
+
+    if (rlen) {
+        dma_channel_config rx = dma_channel_get_default_config(bus->dma_rx);
+        channel_config_set_transfer_data_size(&rx, DMA_SIZE_8);
+        channel_config_set_read_increment(&rx, false);
+        channel_config_set_write_increment(&rx, true);
+        channel_config_set_dreq(&rx, i2c_get_dreq(i2c, false));
+        dma_channel_configure(bus->dma_rx, &rx, dst, &hw->data_cmd, rlen, true);
+    }
+    dma_channel_config tx = dma_channel_get_default_config(bus->dma_tx);
+    channel_config_set_transfer_data_size(&tx, DMA_SIZE_16);
+    channel_config_set_read_increment(&tx, true);
+    channel_config_set_write_increment(&tx, false);
+    channel_config_set_dreq(&tx, i2c_get_dreq(i2c, true));
+
+    hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+    dma_channel_configure(bus->dma_tx, &tx, &hw->data_cmd, bus->cmd, total, true);
+
+    // 9 bits por byte no clock configurado, mais a margem
+    uint32_t wait_ms = (uint32_t)((uint64_t)total * 9 * 1000 / bus->baudrate) + I2C_BUS_TIMEOUT_MS;
+    bool stopped = ulTaskNotifyTakeIndexed(I2C_BUS_NOTIFY_INDEX, pdTRUE, pdMS_TO_TICKS(wait_ms) + 1) != 0;
+    hw->intr_mask = 0;
+    bus->waiter = NULL;
+
+    if (!stopped || bus->abort_source) {
+        dma_channel_abort(bus->dma_tx);
+        if (rlen) dma_channel_abort(bus->dma_rx);
+        (void)hw->clr_tx_abrt;                         // Só com o DMA parado
+        if (!stopped) {
+            hw->enable = 0;                            // Descarta o que ficou no FIFO
+            hw->enable = 1;
+        }
+        return stopped ? PICO_ERROR_GENERIC : PICO_ERROR_TIMEOUT;
+    }
+
+    // O STOP chega com os últimos bytes ainda no FIFO de RX por alguns ciclos
+    while (rlen && dma_channel_is_busy(bus->dma_rx)) {
+        tight_loop_contents();
+    }
+    return (int)(rlen ? rlen : wlen);
+}
+
+// Fallback bloqueante do SDK (sem RTOS ou transferência curta/longa demais)
+static int i2c_bus_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t wlen,
+                            uint8_t *dst, size_t rlen) {
+    if (wlen) {
+        int n = i2c_write_blocking(i2c, addr, src, wlen, rlen != 0);
+        if (n < 0 || !rlen) return n;
+    }
+    return i2c_read_blocking(i2c, addr, dst, rlen, false);
+}
+
+static int i2c_bus_transfer(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t wlen,
+                            uint8_t *dst, size_t rlen) {
+    i2c_bus_t *bus = &buses[i2c_hw_index(i2c)];
+    size_t total = wlen + rlen;
+    if (total == 0) return PICO_ERROR_GENERIC;
+
+    if (!bus->ready || xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+        return i2c_bus_blocking(i2c, addr, src, wlen, dst, rlen);
+    }
+
+    xSemaphoreTake(bus->mutex, portMAX_DELAY);
+    int n = total >= I2C_BUS_DMA_MIN && total <= I2C_BUS_MAX_LEN
+          ? i2c_bus_dma(bus, i2c, addr, src, wlen, dst, rlen)
+          : i2c_bus_blocking(i2c, addr, src, wlen, dst, rlen);
+    xSemaphoreGive(bus->mutex);
+    return n;
+}
+
+int i2c_bus_write(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len) {
+    return i2c_bus_transfer(i2c, addr, src, len, NULL, 0);
+}
+
+int i2c_bus_read(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len) {
+    return i2c_bus_transfer(i2c, addr, NULL, 0, dst, len);
+}
+
+int i2c_bus_write_read(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t wlen,
+                       uint8_t *dst, size_t rlen) {
+    return i2c_bus_transfer(i2c, addr, src, wlen, dst, rlen);
+}
@@ -0,0 +1,50 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware/i2c.h"
+
+// Gerenciador dos barramentos I2C: cada barramento tem um mutex do FreeRTOS
+// e um par de canais de DMA. Transferências longas vão por DMA e a task
+// dorme até a interrupção de STOP do controlador (notificação de task), em
+// vez de esperar em laço. As funções devolvem o mesmo que as do SDK: bytes
+// transferidos ou PICO_ERROR_GENERIC/PICO_ERROR_TIMEOUT.
+//
+// Antes de i2c_bus_init() ou com o escalonador parado, caem nas chamadas
+// bloqueantes do SDK (uso sem RTOS e durante a inicialização).
+
+// Abaixo disso o custo de montar o DMA supera o da espera ativa. Na prática
+// só o framebuffer do SSD1306 e a calibração do BMP280 (25 bytes, uma vez)
+// vão por DMA; as leituras periódicas do AHT20 e do BMP280 (7 bytes com o
+// registrador, ~0,2 ms a 400 kHz) ficam no caminho bloqueante.
+#define I2C_BUS_DMA_MIN       16
+
+// Maior transferência por DMA (framebuffer 128x64 + byte de controle);
+// acima disso a transferência é bloqueante, ainda sob o mutex
+#define I2C_BUS_MAX_LEN       1040
+
+// Margem sobre o tempo de barramento calculado pelo clock
+#define I2C_BUS_TIMEOUT_MS    10
+
+// Índice da notificação de task usado na espera (não colide com o índice 0
+// usado pelas tasks para os próprios eventos)
+#define I2C_BUS_NOTIFY_INDEX  1
+
+// Configura clock, pinos (com pull-up), mutex, canais de DMA e interrupção.
+// Chamadas repetidas para o mesmo barramento não fazem nada.
+bool i2c_bus_init(i2c_inst_t *i2c, uint32_t baudrate, unsigned int sda, unsigned int scl);
+
+// Escrita com STOP no fim
+int i2c_bus_write(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len);
+
+// Leitura com STOP no fim
+int i2c_bus_read(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len);
+
+// Escrita (ex.: endereço de registrador) seguida de leitura com RESTART, sem
+// liberar o barramento entre as duas. Retorna os bytes lidos.
+int i2c_bus_write_read(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t wlen,
+                       uint8_t *dst, size_t rlen);
+
+#endif
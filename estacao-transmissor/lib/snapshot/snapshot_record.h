@@ -0,0 +1,22 @@
+#ifndef SNAPSHOT_RECORD_H
+#define SNAPSHOT_RECORD_H
+
+#include <stdint.h>
+#include "telemetry.h"
+
+// Última leitura dos sensores, com origem, instante e canais válidos
+// (TELEMETRY_FLAG_AHT_OK / TELEMETRY_FLAG_BMP_OK). Os valores de um canal
+// inválido repetem os da última leitura boa.
+// Só o tipo, sem snapshot.c: o transmissor passa o registro pelas filas de
+// sensores (task_sensores.h) e não usa o seqlock.
+typedef struct {
+    uint32_t seq;               // Número da leitura (1, 2, ...), preenchido por quem publica
+    uint32_t timestamp_ms;      // Instante da medição (ms desde o boot)
+    uint8_t node_id;            // Estação de origem (receptor); 0 no transmissor
+    uint8_t flags;              // Canais válidos
+    uint16_t frame_seq;         // Sequência do quadro de origem (receptor); 0 no transmissor
+    telemetry_sample_t sample;  // Mesma escala dos quadros: cC, c%, Pa
+    int16_t bmp_temp_cdeg;      // Temperatura do BMP280 (só no transmissor; não vai ao ar)
+} snapshot_record_t;
+
+#endif
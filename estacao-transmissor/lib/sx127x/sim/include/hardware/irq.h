@@ -0,0 +1,15 @@
+// Substituto de hardware/irq.h: a interrupção do banco de GPIO é sempre
+// entregue pelo emulador
+#ifndef SIM_HARDWARE_IRQ_H
+#define SIM_HARDWARE_IRQ_H
+
+#include <stdbool.h>
+
+#define IO_IRQ_BANK0 13
+
+static inline void irq_set_enabled(unsigned int num, bool enabled) {
+    (void)num;
+    (void)enabled;
+}
+
+#endif
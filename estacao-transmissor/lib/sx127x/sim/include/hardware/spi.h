@@ -0,0 +1,19 @@
+// Substituto de hardware/spi.h: as transferências vão para o rádio
+// selecionado em sx127x_emu.c
+#ifndef SIM_HARDWARE_SPI_H
+#define SIM_HARDWARE_SPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct spi_inst spi_inst_t;
+#define spi0 ((spi_inst_t *)0)
+
+unsigned int spi_init(spi_inst_t *spi, unsigned int baudrate);
+unsigned int spi_set_baudrate(spi_inst_t *spi, unsigned int baudrate);
+unsigned int spi_get_baudrate(const spi_inst_t *spi);
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len);
+int spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx, uint8_t *dst, size_t len);
+int spi_write_read_blocking(spi_inst_t *spi, const uint8_t *src, uint8_t *dst, size_t len);
+
+#endif
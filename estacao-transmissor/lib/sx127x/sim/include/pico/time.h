@@ -0,0 +1,16 @@
+// Substituto de pico/time.h para o emulador no host (sx127x_emu.c):
+// o relógio é o tempo simulado, não o do sistema.
+#ifndef SIM_PICO_TIME_H
+#define SIM_PICO_TIME_H
+
+#include <stdint.h>
+
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+
+// Avança o relógio simulado (processando os eventos do canal no caminho)
+void sleep_ms(uint32_t ms);
+
+static inline void tight_loop_contents(void) {}
+
+#endif
@@ -0,0 +1,62 @@
+// sx127x_emu.h — emulador no host do SX1276 em nível de registradores e do
+// canal de rádio compartilhado, para rodar o sx127x.c original no Linux.
+//
+// Cada rádio tem os seus registradores, FIFO, modo de operação, flags de
+// interrupção e DIO0. O SPI/GPIO substituídos (sim/include) falam com o rádio
+// selecionado por emu_select(); o driver continua com um único estado
+// estático, então todos os rádios devem usar o mesmo perfil.
+//
+// O canal é uma lista de transmissões no tempo simulado. Um receptor em RX
+// no mesmo Frf/SF/BW sincroniza com a transmissão mais forte cujo preâmbulo
+// ainda não passou; no fim dela o pacote chega íntegro, com erro de CRC se
+// outra transmissão no mesmo canal se sobrepôs a menos de EMU_CAPTURE_DB
+// (efeito captura), ou não chega (perda configurada ou SNR abaixo do limite
+// de demodulação do SF).
+
+#ifndef SX127X_EMU_H
+#define SX127X_EMU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define EMU_MAX_RADIOS    128
+#define EMU_CAPTURE_DB    6       // Diferença que preserva o pacote mais forte
+#define EMU_NOISE_FIGURE  6       // dB, para o piso de ruído do receptor
+
+// Tempo acumulado por modo (índice = bits 2-0 de REG_OP_MODE)
+#define EMU_MODES 8
+
+typedef struct {
+    uint32_t tx_frames;       // Transmissões iniciadas
+    uint32_t tx_aborted;      // Saíram de TX antes do fim
+    uint32_t rx_ok;           // RxDone com CRC válido
+    uint32_t rx_crc_error;    // RxDone com CRC inválido (colisão)
+    uint32_t rx_faded;        // Sincronizou, mas o pacote se perdeu (perda configurada)
+    uint32_t rx_missed;       // Preâmbulo chegou com o receptor ocupado em outro pacote
+    uint32_t cad_runs;
+    uint32_t cad_detected;
+    uint64_t mode_us[EMU_MODES];
+} emu_radio_stats_t;
+
+// Cria 'radios' rádios em reset desligado, relógio em zero
+void emu_init(uint8_t radios, uint32_t seed);
+
+// Rádio que recebe o SPI/GPIO do driver (e para onde vai a borda de DIO0)
+void emu_select(uint8_t radio);
+uint8_t emu_selected(void);
+
+// RSSI com que as transmissões do rádio chegam aos demais e a probabilidade
+// (%) de perda de cada pacote por desvanecimento
+void emu_set_link(uint8_t radio, int16_t rssi_dbm, uint8_t loss_pct);
+
+// Processa os eventos do canal até 't_us'. Retorna true se parou antes numa
+// borda de DIO0 (o tratador do driver já foi chamado); chamar de novo
+// continua de onde parou.
+bool emu_run_until(uint64_t t_us);
+
+uint64_t emu_now_us(void);
+
+// Cópia estática (a próxima chamada sobrescreve), com o modo atual contabilizado
+const emu_radio_stats_t *emu_stats(uint8_t radio);
+
+#endif
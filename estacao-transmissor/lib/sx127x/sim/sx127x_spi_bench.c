@@ -0,0 +1,120 @@
+// sx127x_spi_bench.c — transações e tempo de barramento SPI para carregar e
+// ler o FIFO do SX1276, byte a byte (como o driver fazia antes) contra a
+// rajada de sx127x_write_fifo()/sx127x_read_fifo(), no rádio emulado.
+//
+// Compilar e rodar (Linux):
+//   gcc -O2 -Iinclude -I.. -o sx127x_spi_bench sx127x_spi_bench.c sx127x_emu.c ../sx127x_airtime.c ../sx127x_channels.c -lm
+//   ./sx127x_spi_bench
+//
+// O sx127x.c é incluído aqui para que o caminho byte a byte use os próprios
+// sx127x_write_reg()/sx127x_read_reg() (estáticos) do driver. Só a carga e a
+// leitura do FIFO são medidas: o ponteiro FifoAddrPtr é posicionado antes,
+// fora da medição, e nada de IRQ, CAD ou troca de modo entra na conta.
+// O tempo é o do barramento no emulador (bytes × 8 / SCK + 1 µs por ciclo
+// de CS). Sai com código 1 se algum caminho corromper os dados ou se a
+// rajada não ficar em uma transação por quadro.
+
+#include "../sx127x.c"
+#include <stdlib.h>
+#include "sx127x_emu.h"
+
+typedef struct {
+    uint32_t transactions;
+    uint64_t bus_us;
+} bench_cost_t;
+
+static const uint8_t bench_sizes[] = { 12, 96, 255 };
+static const uint32_t bench_bauds[] = { SX127X_SPI_BAUD_SAFE, SX127X_SPI_BAUD };
+
+static bench_cost_t bench_begin(void) {
+    return (bench_cost_t){ sx127x_get_spi_transactions(), emu_now_us() };
+}
+
+static bench_cost_t bench_end(bench_cost_t start) {
+    return (bench_cost_t){ sx127x_get_spi_transactions() - start.transactions,
+                           emu_now_us() - start.bus_us };
+}
+
+// Carga do FIFO como em sx127x_send_message() antes da rajada
+static bench_cost_t load_bytewise(const uint8_t *data, uint8_t len) {
+    sx127x_write_reg(REG_FIFO_ADDR_PTR, 0x00);
+    bench_cost_t c = bench_begin();
+    for (uint8_t i = 0; i < len; i++) sx127x_write_reg(REG_FIFO, data[i]);
+    return bench_end(c);
+}
+
+static bench_cost_t load_burst(const uint8_t *data, uint8_t len) {
+    sx127x_write_reg(REG_FIFO_ADDR_PTR, 0x00);
+    bench_cost_t c = bench_begin();
+    sx127x_write_fifo(data, len);
+    return bench_end(c);
+}
+
+// Leitura como em sx127x_receive_message() antes da rajada
+static bench_cost_t read_bytewise(uint8_t *data, uint8_t len) {
+    sx127x_write_reg(REG_FIFO_ADDR_PTR, 0x00);
+    bench_cost_t c = bench_begin();
+    for (uint8_t i = 0; i < len; i++) data[i] = sx127x_read_reg(REG_FIFO);
+    return bench_end(c);
+}
+
+static bench_cost_t read_burst(uint8_t *data, uint8_t len) {
+    sx127x_write_reg(REG_FIFO_ADDR_PTR, 0x00);
+    bench_cost_t c = bench_begin();
+    sx127x_read_fifo(data, len);
+    return bench_end(c);
+}
+
+int main(void) {
+    int failures = 0;
+    uint8_t frame[255], back[255];
+    for (int i = 0; i < (int)sizeof(frame); i++) frame[i] = (uint8_t)(i * 37 + 11);
+
+    emu_init(1, 1);
+    emu_select(0);
+    if (!sx127x_init()) {
+        printf("SX1276 emulado não respondeu\n");
+        return 1;
+    }
+    sx127x_standby();                 // O FIFO não é acessível em sleep
+
+    printf("%-8s %5s  %-10s %12s %12s %12s %12s\n", "SCK", "bytes", "modo",
+           "carga trans.", "carga µs", "leitura tr.", "leitura µs");
+    for (size_t b = 0; b < sizeof(bench_bauds) / sizeof(bench_bauds[0]); b++) {
+        spi_set_baudrate(SPI_PORT, bench_bauds[b]);
+        for (size_t s = 0; s < sizeof(bench_sizes); s++) {
+            uint8_t len = bench_sizes[s];
+            bench_cost_t lb = load_bytewise(frame, len);
+            memset(back, 0, sizeof(back));
+            bench_cost_t rb = read_bytewise(back, len);
+            if (memcmp(frame, back, len) != 0) failures++;
+
+            memset(back, 0, sizeof(back));
+            bench_cost_t lr = load_burst(frame, len);
+            bench_cost_t rr = read_burst(back, len);
+            if (memcmp(frame, back, len) != 0) failures++;
+            if (lr.transactions != 1 || rr.transactions != 1) failures++;
+
+            printf("%5lu MHz %5u  %-10s %12lu %12llu %12lu %12llu\n",
+                   (unsigned long)(bench_bauds[b] / 1000000), len, "byte",
+                   (unsigned long)lb.transactions, (unsigned long long)lb.bus_us,
+                   (unsigned long)rb.transactions, (unsigned long long)rb.bus_us);
+            printf("%9s %5s  %-10s %12lu %12llu %12lu %12llu\n", "", "", "rajada",
+                   (unsigned long)lr.transactions, (unsigned long long)lr.bus_us,
+                   (unsigned long)rr.transactions, (unsigned long long)rr.bus_us);
+        }
+    }
+
+    // Antes: byte a byte a 1 MHz; depois: rajada no SCK padrão
+    spi_set_baudrate(SPI_PORT, SX127X_SPI_BAUD_SAFE);
+    bench_cost_t before = load_bytewise(frame, 96);
+    spi_set_baudrate(SPI_PORT, SX127X_SPI_BAUD);
+    bench_cost_t after = load_burst(frame, 96);
+    printf("\nQuadro de 96 bytes: %lu transações / %llu µs antes, %lu / %llu µs depois (%.1fx)\n",
+           (unsigned long)before.transactions, (unsigned long long)before.bus_us,
+           (unsigned long)after.transactions, (unsigned long long)after.bus_us,
+           (double)before.bus_us / (double)after.bus_us);
+
+    printf("%s\n", failures ? "FALHOU" : "ok");
+    return failures ? 1 : 0;
+}
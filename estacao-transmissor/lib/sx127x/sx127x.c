@@ -1,6 +1,7 @@
 #include "sx127x.h"
 #include "hardware/spi.h"
 #include "hardware/gpio.h"
+#include "hardware/irq.h"
 #include "pico/time.h"
 #include <string.h>
 #include <stdio.h>
@@ -16,6 +17,16 @@
 #define PIN_MOSI 19      // Master Out Slave In - dados do microcontrolador para o m�dulo
 #define PIN_SCK  18      // Serial Clock - sinal de clock para sincroniza��o SPI
 
+// === Clock do SPI ===
+// O SX1276 aceita SCK de até 10 MHz. O valor pode ser sobrescrito na compilação
+// (target_compile_definitions); se o chip não responder nessa velocidade,
+// sx127x_init() volta para SX127X_SPI_BAUD_SAFE.
+#ifndef SX127X_SPI_BAUD
+#define SX127X_SPI_BAUD      (8 * 1000 * 1000)
+#endif
+#define SX127X_SPI_BAUD_MAX  (10 * 1000 * 1000)
+#define SX127X_SPI_BAUD_SAFE (1 * 1000 * 1000)
+
 // === Registradores do SX1276 - Mapeamento dos endere�os de mem�ria ===
 #define REG_FIFO           0x00  // Buffer FIFO para dados TX/RX
 #define REG_OP_MODE        0x01  // Modo de opera��o (LoRa, FSK, Sleep, TX, RX, etc.)
@@ -23,10 +34,13 @@
 #define REG_FRF_MID        0x07  // Frequ�ncia da portadora - byte do meio
 #define REG_FRF_LSB        0x08  // Frequ�ncia da portadora - byte menos significativo
 #define REG_PA_CONFIG      0x09  // Configura��o do amplificador de pot�ncia
+#define REG_PA_RAMP        0x0A  // Tempo de rampa do PA
+#define REG_OCP            0x0B  // Proteção de sobrecorrente do PA
 #define REG_FIFO_ADDR_PTR  0x0D  // Ponteiro de endere�o FIFO
 #define REG_FIFO_TX_BASE   0x0E  // Endere�o base FIFO para transmiss�o
 #define REG_FIFO_RX_BASE   0x0F  // Endere�o base FIFO para recep��o
 #define REG_IRQ_FLAGS      0x12  // Flags de interrup��o (TX done, RX done, etc.)
+#define REG_PKT_SNR        0x19  // SNR do último pacote (complemento de 2, passos de 0,25 dB)
 #define REG_RX_NB_BYTES    0x13  // N�mero de bytes recebidos
 #define REG_PKT_RSSI       0x1A  // Intensidade do sinal recebido (RSSI)
 #define REG_MODEM_CONFIG1  0x1D  // Configura��o do modem: Bandwidth, Coding Rate, Header
@@ -35,14 +49,36 @@
 #define REG_PAYLOAD_LEN    0x22  // Comprimento do payload
 #define REG_PREAMBLE_MSB   0x20  // Comprimento do pre�mbulo - byte mais significativo
 #define REG_PREAMBLE_LSB   0x21  // Comprimento do pre�mbulo - byte menos significativo
+#define REG_HOP_CHANNEL    0x1C  // Bit 6: CrcOnPayload do header recebido
 #define REG_MODEM_CONFIG3  0x26  // Configura��o adicional: Low Data Rate Optimizer, AGC
+#define REG_FIFO_RX_CURRENT 0x10 // Endereço do último pacote recebido no FIFO
+#define REG_FEI_MSB        0x28  // Erro de frequência estimado (20 bits, 0x28..0x2A)
+#define REG_DIO_MAPPING_1  0x40  // Mapeamento das funções de DIO0..DIO3
+#define REG_DETECTION_OPT  0x31  // Otimização de detecção (especial para SF6)
+#define REG_DETECTION_THR  0x37  // Limiar de detecção (especial para SF6)
+#define REG_PA_DAC         0x4D  // Habilita +20 dBm no PA_BOOST
 
 // === Modos de opera��o - Valores para o registrador REG_OP_MODE ===
 #define MODE_LONG_RANGE_MODE  0x80  // Habilita o modo LoRa (bit 7 = 1)
 #define MODE_TX               0x83  // Modo de transmiss�o: LoRa + TX
 #define MODE_RX_CONTINUOUS    0x85  // Modo de recep��o cont�nua: LoRa + RX
+#define MODE_SLEEP            0x80  // LoRa + Sleep (FIFO inacessível)
+#define MODE_STDBY            0x81  // LoRa + Standby
+#define MODE_CAD              0x87  // LoRa + detecção de atividade no canal
 #define PA_BOOST              0x80  // Habilita o amplificador PA_BOOST para alta pot�ncia
 
+// === Perfil padrão compartilhado pelas duas estações ===
+// 915 MHz, SF7, 125 kHz, CR 4/5, 17 dBm, preâmbulo de 8 símbolos, header explícito
+const sx127x_profile_t sx127x_profile_default = SX127X_PROFILE_DEFAULT;
+
+// Perfil aplicado por último em sx127x_configure()
+static sx127x_profile_t active_profile;
+
+// === Função do pino DIO0 (bits 7-6 de REG_DIO_MAPPING_1) ===
+#define DIO0_RX_DONE          0x00
+#define DIO0_TX_DONE          0x40
+#define DIO0_CAD_DONE         0x80
+
 // === Reset do LoRa - Reinicializa��o por hardware ===
 static void sx127x_reset() {
     gpio_put(PIN_RST, 0);    // Coloca o pino de reset em n�vel baixo
@@ -51,6 +87,9 @@ static void sx127x_reset() {
     sleep_ms(100);           // Aguarda estabiliza��o ap�s o reset
 }
 
+// Contador de transações SPI (um ciclo de CS = uma transação)
+static uint32_t spi_transactions = 0;
+
 // === Leitura de registrador via SPI ===
 static uint8_t sx127x_read_reg(uint8_t addr) {
     uint8_t tx[] = { addr & 0x7F, 0x00 };  // Bit 7 = 0 para leitura, endere�o + dummy byte
@@ -58,6 +97,7 @@ static uint8_t sx127x_read_reg(uint8_t addr) {
     gpio_put(PIN_CS, 0);                   // Seleciona o dispositivo (CS baixo)
     spi_write_read_blocking(SPI_PORT, tx, rx, 2);  // Transfer�ncia SPI bidirecional
     gpio_put(PIN_CS, 1);                   // Libera a sele��o (CS alto)
+    spi_transactions++;
     return rx[1];                          // Retorna o dado lido (segundo byte)
 }
 
@@ -67,13 +107,136 @@ static void sx127x_write_reg(uint8_t addr, uint8_t value) {
     gpio_put(PIN_CS, 0);                   // Seleciona o dispositivo (CS baixo)
     spi_write_blocking(SPI_PORT, tx, 2);   // Transfer�ncia SPI (apenas escrita)
     gpio_put(PIN_CS, 1);                   // Libera a sele��o (CS alto)
+    spi_transactions++;
+}
+
+// === Escrita em rajada (burst) via SPI ===
+// Envia o endereço uma única vez e transfere todos os bytes no mesmo ciclo de CS.
+// Em REG_FIFO o ponteiro FifoAddrPtr avança sozinho a cada byte.
+static void sx127x_write_burst(uint8_t addr, const uint8_t *data, uint8_t len) {
+    uint8_t cmd = addr | 0x80;
+    gpio_put(PIN_CS, 0);
+    spi_write_blocking(SPI_PORT, &cmd, 1);
+    spi_write_blocking(SPI_PORT, data, len);
+    gpio_put(PIN_CS, 1);
+    spi_transactions++;
+}
+
+// === Leitura em rajada (burst) via SPI ===
+static void sx127x_read_burst(uint8_t addr, uint8_t *data, uint8_t len) {
+    uint8_t cmd = addr & 0x7F;
+    gpio_put(PIN_CS, 0);
+    spi_write_blocking(SPI_PORT, &cmd, 1);
+    spi_read_blocking(SPI_PORT, 0x00, data, len);
+    gpio_put(PIN_CS, 1);
+    spi_transactions++;
+}
+
+// === Acesso ao FIFO a partir da posição atual de FifoAddrPtr ===
+void sx127x_write_fifo(const uint8_t *data, uint8_t len) {
+    if (len == 0) return;
+    sx127x_write_burst(REG_FIFO, data, len);
+}
+
+void sx127x_read_fifo(uint8_t *data, uint8_t len) {
+    if (len == 0) return;
+    sx127x_read_burst(REG_FIFO, data, len);
+}
+
+uint32_t sx127x_get_spi_transactions(void) {
+    return spi_transactions;
+}
+
+uint32_t sx127x_get_spi_baud(void) {
+    return spi_get_baudrate(SPI_PORT);
+}
+
+// === Aplica um perfil de rádio ===
+// Os registradores contíguos são escritos em rajada: 0x06..0x0B (FRF, PA, OCP)
+// e 0x1D..0x22 (modem, preâmbulo e payload); REG_MODEM_CONFIG3 fica separado.
+bool sx127x_configure(const sx127x_profile_t *p) {
+    if (p->sf < 6 || p->sf > 12) return false;
+    if (p->bw > SX127X_BW_500K) return false;
+    if (p->cr < 1 || p->cr > 4) return false;
+    if (p->preamble_len < 6) return false;
+    if (p->sf == 6 && (!p->implicit_header || p->payload_len == 0)) return false;  // SF6 exige header implícito
+
+    // Registradores de modem só podem ser alterados em sleep/standby
+    sx127x_write_reg(REG_OP_MODE, MODE_STDBY);
+
+    // ========== FREQUÊNCIA E POTÊNCIA ==========
+    // Frf = Freq × 2^19 / 32 MHz
+    uint32_t frf = (uint32_t)(((uint64_t)p->frequency_hz << 19) / 32000000u);
+
+    // PA_BOOST: Pout = 2 + OutputPower (2..17 dBm); 20 dBm exige PA_DAC e OCP maior
+    int8_t power = p->tx_power_dbm;
+    uint8_t pa_dac = 0x84, ocp = 0x2B;                 // Padrão: 100 mA
+    if (power >= 20) {
+        power = 17;
+        pa_dac = 0x87;
+        ocp = 0x31;                                    // 140 mA
+    } else if (power > 17) {
+        power = 17;
+    } else if (power < 2) {
+        power = 2;
+    }
+    uint8_t rf[6] = {
+        (uint8_t)(frf >> 16), (uint8_t)(frf >> 8), (uint8_t)frf,
+        PA_BOOST | (uint8_t)(power - 2),
+        0x09,                                          // PaRamp = 40 us (padrão)
+        ocp,
+    };
+    sx127x_write_burst(REG_FRF_MSB, rf, sizeof(rf));
+    sx127x_write_reg(REG_PA_DAC, pa_dac);
+
+    // ========== MODEM, PREÂMBULO E PAYLOAD ==========
+    // REG_MODEM_CONFIG1: Bandwidth (7-4) | CodingRate (3-1) | ImplicitHeaderModeOn (0)
+    // REG_MODEM_CONFIG2: SpreadingFactor (7-4) | RxPayloadCrcOn (2) | SymbTimeout(9:8)
+    uint8_t modem[6] = {
+        (uint8_t)((p->bw << 4) | (p->cr << 1) | (p->implicit_header ? 0x01 : 0x00)),
+        (uint8_t)((p->sf << 4) | (p->crc_on ? 0x04 : 0x00)),
+        0x64,                                          // SymbTimeout LSB (padrão)
+        (uint8_t)(p->preamble_len >> 8),
+        (uint8_t)(p->preamble_len & 0xFF),
+        p->payload_len ? p->payload_len : 0xFF,        // Em header explícito só vale para TX
+    };
+    sx127x_write_burst(REG_MODEM_CONFIG1, modem, sizeof(modem));
+
+    // REG_MODEM_CONFIG3: LowDataRateOptimize (3) | AgcAutoOn (2)
+    sx127x_write_reg(REG_MODEM_CONFIG3, (sx127x_ldro_enabled(p) ? 0x08 : 0x00) | 0x04);
+
+    // Ajustes de detecção recomendados pelo datasheet para SF6
+    sx127x_write_reg(REG_DETECTION_OPT, p->sf == 6 ? 0xC5 : 0xC3);
+    sx127x_write_reg(REG_DETECTION_THR, p->sf == 6 ? 0x0C : 0x0A);
+
+    active_profile = *p;
+    return true;
+}
+
+void sx127x_get_profile(sx127x_profile_t *out) {
+    *out = active_profile;
+}
+
+// === Salto de frequência: só os registradores de Frf ===
+bool sx127x_set_channel(uint8_t ch) {
+    const sx127x_channel_t *c = sx127x_channel(ch);
+    if (!c) return false;
+
+    // Frf só é recalculado pelo sintetizador ao sair de standby
+    sx127x_write_reg(REG_OP_MODE, MODE_STDBY);
+    sx127x_write_burst(REG_FRF_MSB, c->frf, sizeof(c->frf));
+    active_profile.frequency_hz = c->frequency_hz;
+    return true;
 }
 
 // === Inicializa��o do m�dulo SX1276 ===
 bool sx127x_init() {
     // ========== INICIALIZA��O DO HARDWARE ==========
-    // Configura SPI com velocidade de 1 MHz
-    spi_init(SPI_PORT, 1 * 1000 * 1000);
+    // Configura SPI com a velocidade definida em SX127X_SPI_BAUD
+    uint32_t baud = spi_init(SPI_PORT, SX127X_SPI_BAUD);
+    if (baud > SX127X_SPI_BAUD_MAX) {
+        baud = spi_set_baudrate(SPI_PORT, SX127X_SPI_BAUD_SAFE);  // Divisor não atingiu o limite do chip
+    }
     
     // Define as fun��es dos pinos GPIO para SPI
     gpio_set_function(PIN_MISO, GPIO_FUNC_SPI);  // Configura MISO como fun��o SPI
@@ -91,58 +254,20 @@ bool sx127x_init() {
     // ========== VERIFICA��O DO CHIP ==========
     // Verifica se o chip est� respondendo corretamente
     uint8_t version = sx127x_read_reg(REG_VERSION);
+    if (version != 0x12 && baud > SX127X_SPI_BAUD_SAFE) {
+        // Fiação longa ou módulo lento: repete a verificação no clock seguro
+        baud = spi_set_baudrate(SPI_PORT, SX127X_SPI_BAUD_SAFE);
+        version = sx127x_read_reg(REG_VERSION);
+    }
     if (version != 0x12) return false;  // SX1276 deve retornar 0x12
 
     // ========== CONFIGURA��O B�SICA ==========
-    // Habilita o modo LoRa e coloca em standby
-    sx127x_write_reg(REG_OP_MODE, MODE_LONG_RANGE_MODE);
-
-    // ========== CONFIGURA��O DE FREQU�NCIA ==========
-    // Frequ�ncia = 915 MHz (915.000.000 Hz)
-    // C�lculo: Frf = (Freq � 2^19) / 32MHz = 915000000 � 524288 / 32000000 = 14991360 = 0xE4C000
-    sx127x_write_reg(REG_FRF_MSB, 0xE4);  // Byte mais significativo da frequ�ncia
-    sx127x_write_reg(REG_FRF_MID, 0xC0);  // Byte do meio da frequ�ncia
-    sx127x_write_reg(REG_FRF_LSB, 0x00);  // Byte menos significativo da frequ�ncia
-
-    // ========== CONFIGURA��O DE POT�NCIA DE TRANSMISS�O ==========
-    // Pot�ncia de transmiss�o = 17 dBm
-    // PA_BOOST (0x80) + OutputPower (0x0F) = 0x8F
-    // F�rmula: Pout = 17 - (15 - OutputPower) = 17 - (15 - 15) = 17 dBm
-    sx127x_write_reg(REG_PA_CONFIG, PA_BOOST | 0x0F);
-
-    // ========== CONFIGURA��O DO MODEM - REGISTRADOR 1 ==========
-    // REG_MODEM_CONFIG1 = 0x73 (01110011)
-    // Bits 7-5: Bandwidth = 0111 (125 kHz)
-    // Bits 4-2: Coding Rate = 001 (4/5 - taxa de corre��o de erro)
-    // Bit 1: ImplicitHeaderModeOn = 1 (Header impl�cito = DISABLED)
-    // Bit 0: Reserved = 1
-    sx127x_write_reg(REG_MODEM_CONFIG1, 0x73);
-
-    // ========== CONFIGURA��O DO MODEM - REGISTRADOR 2 ==========
-    // REG_MODEM_CONFIG2 = 0x70 (01110000)
-    // Bits 7-4: Spreading Factor = 0111 (SF7)
-    // Bit 3: TxContinuousMode = 0 (modo normal)
-    // Bit 2: RxPayloadCrcOn = 0 (CRC desabilitado)
-    // Bits 1-0: SymbTimeout = 00 (timeout padr�o)
-    sx127x_write_reg(REG_MODEM_CONFIG2, 0x70);
-
-    // ========== CONFIGURA��O DO PRE�MBULO ==========
-    // Pre�mbulo = 8 s�mbolos
-    // O pre�mbulo � usado para sincroniza��o entre transmissor e receptor
-    sx127x_write_reg(REG_PREAMBLE_MSB, 0x00);  // MSB = 0 (total = 8)
-    sx127x_write_reg(REG_PREAMBLE_LSB, 0x08);  // LSB = 8 s�mbolos
-
-    // ========== CONFIGURA��O DO MODEM - REGISTRADOR 3 ==========
-    // REG_MODEM_CONFIG3 = 0x04 (00000100)
-    // Bit 3: LowDataRateOptimize = 0 (otimiza��o para baixa taxa desabilitada)
-    // Bit 2: AgcAutoOn = 1 (controle autom�tico de ganho habilitado)
-    // Outros bits: reservados = 0
-    sx127x_write_reg(REG_MODEM_CONFIG3, 0x04);
-
-    // ========== CONFIGURA��O DO PAYLOAD ==========
-    // Define o comprimento fixo do payload = 10 bytes
-    // No modo de header impl�cito, o comprimento deve ser definido previamente
-    sx127x_write_reg(REG_PAYLOAD_LEN, 32);
+    // Habilita o modo LoRa (o bit LongRangeMode só muda em sleep)
+    sx127x_write_reg(REG_OP_MODE, MODE_SLEEP);
+
+    // ========== PERFIL DE RÁDIO ==========
+    // Frequência, potência, SF, BW, CR, preâmbulo, CRC e header
+    if (!sx127x_configure(&sx127x_profile_default)) return false;
 
     // ========== CONFIGURA��O DO BUFFER FIFO ==========
     // Define os endere�os base para transmiss�o e recep��o no buffer FIFO
@@ -152,72 +277,191 @@ bool sx127x_init() {
     return true;  // Inicializa��o bem-sucedida
 }
 
-// === Envia uma mensagem via LoRa ===
-bool sx127x_send_message(const char *msg) {
-    int len = strlen(msg);
-    if (len > 255) return false;  // Verifica se a mensagem n�o excede o limite
+// === Callback de DIO0 ===
+static sx127x_dio0_callback_t dio0_callback = NULL;
 
-    // ========== PREPARA��O PARA TRANSMISS�O ==========
-    // Coloca o m�dulo em modo standby (LoRa habilitado)
-    sx127x_write_reg(REG_OP_MODE, MODE_LONG_RANGE_MODE);
-    
-    // Aponta o ponteiro FIFO para o in�cio do buffer de transmiss�o
-    sx127x_write_reg(REG_FIFO_ADDR_PTR, 0x00);
+// Instante da última borda do DIO0 (timestamp do pacote recebido)
+static volatile uint64_t dio0_timestamp_us = 0;
 
-    // ========== CARREGAMENTO DOS DADOS NO FIFO ==========
-    // Escreve cada byte da mensagem no buffer FIFO
-    for (int i = 0; i < len; i++) {
-        sx127x_write_reg(REG_FIFO, msg[i]);
+// Handler "raw" do GPIO: reconhece a borda e repassa para a aplicação.
+// Não acessa o SPI aqui; quem for acordado lê REG_IRQ_FLAGS no contexto de task.
+static void sx127x_dio0_isr(void) {
+    if (gpio_get_irq_event_mask(PIN_DIO0) & GPIO_IRQ_EDGE_RISE) {
+        gpio_acknowledge_irq(PIN_DIO0, GPIO_IRQ_EDGE_RISE);
+        dio0_timestamp_us = time_us_64();
+        if (dio0_callback) dio0_callback();
     }
+}
+
+void sx127x_set_dio0_callback(sx127x_dio0_callback_t cb) {
+    static bool handler_installed = false;
+    dio0_callback = cb;
+    if (!handler_installed) {
+        // Handler dedicado ao pino: não interfere no callback compartilhado dos botões
+        gpio_add_raw_irq_handler(PIN_DIO0, sx127x_dio0_isr);
+        irq_set_enabled(IO_IRQ_BANK0, true);
+        handler_installed = true;
+    }
+    gpio_set_irq_enabled(PIN_DIO0, GPIO_IRQ_EDGE_RISE, cb != NULL);
+}
+
+// === Lê e limpa as flags de interrupção pendentes ===
+uint8_t sx127x_take_irq_flags(void) {
+    uint8_t flags = sx127x_read_reg(REG_IRQ_FLAGS);
+    if (flags) sx127x_write_reg(REG_IRQ_FLAGS, flags);  // Escrever 1 limpa a flag (e baixa o DIO0)
+    return flags;
+}
 
-    // ========== CONFIGURA��O DO COMPRIMENTO ==========
-    // Define o comprimento da mensagem a ser transmitida
-    // NOTA: Isso sobrescreve o valor fixo definido na inicializa��o
+// === Inicia a transmissão sem aguardar o TxDone ===
+bool sx127x_start_tx(const uint8_t *data, uint8_t len) {
+    if (len == 0) return false;
+
+    // FIFO só é acessível fora do modo sleep
+    sx127x_write_reg(REG_OP_MODE, MODE_STDBY);
+
+    // Carrega o payload a partir da base de TX em uma única rajada SPI
+    sx127x_write_reg(REG_FIFO_ADDR_PTR, 0x00);
+    sx127x_write_fifo(data, len);
     sx127x_write_reg(REG_PAYLOAD_LEN, len);
 
-    // ========== IN�CIO DA TRANSMISS�O ==========
-    // Coloca o m�dulo em modo de transmiss�o
+    // DIO0 sinaliza TxDone; descarta flags antigas antes de entrar em TX
+    sx127x_write_reg(REG_DIO_MAPPING_1, DIO0_TX_DONE);
+    sx127x_write_reg(REG_IRQ_FLAGS, 0xFF);
     sx127x_write_reg(REG_OP_MODE, MODE_TX);
+    return true;
+}
+
+// === Coloca o rádio em recepção contínua com DIO0 = RxDone ===
+void sx127x_start_rx(void) {
+    sx127x_write_reg(REG_OP_MODE, MODE_STDBY);
+    sx127x_write_reg(REG_DIO_MAPPING_1, DIO0_RX_DONE);
+    sx127x_write_reg(REG_FIFO_ADDR_PTR, 0x00);
+    sx127x_write_reg(REG_IRQ_FLAGS, 0xFF);
+    sx127x_write_reg(REG_OP_MODE, MODE_RX_CONTINUOUS);
+}
+
+// === Encerra TX/RX em andamento ===
+void sx127x_standby(void) {
+    sx127x_write_reg(REG_OP_MODE, MODE_STDBY);
+}
 
-    // ========== AGUARDA CONCLUS�O DA TRANSMISS�O ==========
-    // Monitora a flag TxDone (bit 3) no registrador de interrup��es
-    while ((sx127x_read_reg(REG_IRQ_FLAGS) & 0x08) == 0) {
-        tight_loop_contents();  // Loop otimizado para economizar energia
+// === Sleep entre ciclos (o oscilador desliga; LongRangeMode permanece) ===
+void sx127x_sleep(void) {
+    sx127x_write_reg(REG_OP_MODE, MODE_SLEEP);
+}
+
+// === Detecção de atividade no canal (CAD) com DIO0 = CadDone ===
+void sx127x_start_cad(void) {
+    sx127x_write_reg(REG_OP_MODE, MODE_STDBY);
+    sx127x_write_reg(REG_DIO_MAPPING_1, DIO0_CAD_DONE);
+    sx127x_write_reg(REG_IRQ_FLAGS, 0xFF);
+    sx127x_write_reg(REG_OP_MODE, MODE_CAD);
+}
+
+// === CAD bloqueante, por polling ===
+bool sx127x_channel_busy(void) {
+    sx127x_start_cad();
+
+    // O CAD dura cerca de 2 símbolos; a margem cobre o atraso do oscilador
+    uint32_t deadline = time_us_32() + 4 * sx127x_symbol_time_us(&active_profile) + 1000;
+    uint8_t flags;
+    while (((flags = sx127x_read_reg(REG_IRQ_FLAGS)) & SX127X_IRQ_CAD_DONE) == 0) {
+        if ((int32_t)(time_us_32() - deadline) >= 0) break;
+        tight_loop_contents();
     }
+    sx127x_write_reg(REG_IRQ_FLAGS, flags);
+    sx127x_write_reg(REG_OP_MODE, MODE_STDBY);
+    return (flags & SX127X_IRQ_CAD_DETECTED) != 0;
+}
+
+// === Qualidade do último pacote: RSSI, SNR e erro de frequência ===
+static void sx127x_read_link_quality(sx127x_packet_t *pkt) {
+    // 0x19 PktSnr | 0x1A PktRssi | 0x1B Rssi | 0x1C HopChannel em uma rajada
+    uint8_t q[4];
+    sx127x_read_burst(REG_PKT_SNR, q, sizeof(q));
+    int8_t snr = (int8_t)q[0];
+    int16_t pkt_rssi = q[1];
+
+    // Offset depende da porta de RF: HF (banda de 868/915 MHz) ou LF
+    int16_t offset = active_profile.frequency_hz < 525000000u ? -164 : -157;
+    if (snr >= 0) pkt_rssi = (int16_t)(pkt_rssi * 16 / 15);  // Correção de linearidade
+    else          pkt_rssi = (int16_t)(pkt_rssi + snr / 4);   // Abaixo do ruído o SNR domina
+    pkt->rssi_dbm = (int16_t)(offset + pkt_rssi);
+    pkt->snr_x4 = snr;
+
+    // FEI: Ferr = FreqError × 2^24 / Fxtal × BW / 500 kHz
+    uint8_t f[3];
+    sx127x_read_burst(REG_FEI_MSB, f, sizeof(f));
+    int32_t fei = ((int32_t)(f[0] & 0x0F) << 16) | ((int32_t)f[1] << 8) | f[2];
+    if (fei & 0x80000) fei -= 0x100000;                       // Sinal em 20 bits
+    pkt->freq_error_hz = (int32_t)((int64_t)fei * (1 << 24) * sx127x_bandwidth_hz(&active_profile)
+                                   / (32000000LL * 500000LL));
+
+    // Header explícito: CrcOnPayload indica se o transmissor anexou o CRC
+    pkt->crc_ok = (q[3] & 0x40) != 0 || !active_profile.crc_on || active_profile.implicit_header;
+}
+
+// === Copia o último pacote recebido do FIFO ===
+bool sx127x_read_packet(uint8_t irq_flags, uint8_t *buf, uint8_t max_len, sx127x_packet_t *pkt) {
+    sx127x_packet_t info;
+    sx127x_read_link_quality(&info);
+    info.timestamp_us = dio0_timestamp_us;
+    if (irq_flags & SX127X_IRQ_CRC_ERROR) info.crc_ok = false;
+
+    uint8_t len = 0;
+    if (info.crc_ok) {
+        len = sx127x_read_reg(REG_RX_NB_BYTES);
+        if (len > max_len) len = max_len;
+
+        // Aponta o ponteiro FIFO para o início do pacote recebido
+        sx127x_write_reg(REG_FIFO_ADDR_PTR, sx127x_read_reg(REG_FIFO_RX_CURRENT));
+        sx127x_read_fifo(buf, len);
+    }
+    info.len = len;
+
+    if (pkt) *pkt = info;
+    return info.crc_ok;
+}
+
+// === Envia uma mensagem via LoRa (bloqueante, por polling) ===
+// Mantida para uso sem RTOS; as tasks usam sx127x_start_tx() + DIO0.
+bool sx127x_send_message(const char *msg) {
+    size_t len = strlen(msg);
+    if (len > 255) return false;  // Verifica se a mensagem n�o excede o limite
+
+    // Canal ocupado: espera aleatória de até 2^(i+1) tempos de pacote
+    uint32_t airtime_ms = sx127x_time_on_air_us(&active_profile, (uint8_t)len) / 1000 + 1;
+    for (int i = 0; i < SX127X_SEND_CAD_ATTEMPTS && sx127x_channel_busy(); i++) {
+        sleep_ms(1 + time_us_32() % (airtime_ms << (i + 1)));
+    }
+
+    if (!sx127x_start_tx((const uint8_t *)msg, (uint8_t)len)) return false;
+
+    // Monitora a flag TxDone no registrador de interrup��es
+    while ((sx127x_read_reg(REG_IRQ_FLAGS) & SX127X_IRQ_TX_DONE) == 0) {
+        tight_loop_contents();
+    }
+    sx127x_write_reg(REG_IRQ_FLAGS, SX127X_IRQ_TX_DONE);
 
-    // ========== LIMPEZA DA FLAG DE INTERRUP��O ==========
-    // Limpa a flag TxDone para futuras transmiss�es
-    sx127x_write_reg(REG_IRQ_FLAGS, 0x08);
-    
     return true;  // Transmiss�o bem-sucedida
 }
 
-// === Recebe uma mensagem via LoRa (modo cont�nuo) ===
+// === Recebe uma mensagem via LoRa (modo cont�nuo, por polling) ===
 bool sx127x_receive_message(char *buf, uint8_t max_len) {
-    // ========== CONFIGURA��O DO MODO DE RECEP��O ==========
+    if (max_len == 0) return false;
+
     // Coloca o m�dulo em modo de recep��o cont�nua
     sx127x_write_reg(REG_OP_MODE, MODE_RX_CONTINUOUS);
 
-    // ========== VERIFICA��O DE MENSAGEM RECEBIDA ==========
-    // Verifica se a flag RxDone (bit 6) est� ativa
-    if ((sx127x_read_reg(REG_IRQ_FLAGS) & 0x40) == 0) return false;
+    // Verifica se a flag RxDone est� ativa
+    uint8_t flags = sx127x_read_reg(REG_IRQ_FLAGS);
+    if ((flags & SX127X_IRQ_RX_DONE) == 0) return false;
+    sx127x_write_reg(REG_IRQ_FLAGS, flags);
 
-    // ========== LIMPEZA DA FLAG DE INTERRUP��O ==========
-    // Limpa a flag RxDone
-    sx127x_write_reg(REG_IRQ_FLAGS, 0x40);
-
-    // ========== LEITURA DOS DADOS RECEBIDOS ==========
-    // Obt�m o n�mero de bytes recebidos
-    uint8_t len = sx127x_read_reg(REG_RX_NB_BYTES);
-    
-    // Aponta o ponteiro FIFO para o endere�o atual de recep��o
-    sx127x_write_reg(REG_FIFO_ADDR_PTR, sx127x_read_reg(0x10)); // FifoRxCurrentAddr
-
-    // L� os dados do FIFO para o buffer de destino
-    for (int i = 0; i < len && i < max_len - 1; i++) {
-        buf[i] = sx127x_read_reg(REG_FIFO);
-    }
-    buf[len] = '\0';  // Adiciona terminador de string
+    // Pacotes com CRC inválido são descartados pelo próprio rádio
+    sx127x_packet_t pkt;
+    if (!sx127x_read_packet(flags, (uint8_t *)buf, max_len - 1, &pkt)) return false;
+    buf[pkt.len] = '\0';  // Adiciona terminador de string
 
     return true;  // Recep��o bem-sucedida
-}
\ No newline at end of file
+}
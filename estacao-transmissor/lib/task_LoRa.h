@@ -8,79 +8,231 @@
 #include "pico/stdlib.h"
 #include "FreeRTOS.h"
 #include "task.h"
-#include "sx127x.h"   // já cuida de pinos e setup no seu projeto
+#include "task_radio.h"  // fila assíncrona e task dona do SX1276
+#include "telemetry.h"    // quadro binário compartilhado com o receptor
+#include "task_sensores.h" // leituras entregues por sensores_lora_queue
+
+// Intervalo mínimo entre envios (ms). O intervalo efetivo é o maior entre
+// este e radio_tx_interval_ms() (orçamento de duty cycle espalhado pela
+// janela: 4,2 s para 42 ms no ar a 1%), arredondado para múltiplos de
+// SENSORES_PERIOD_MS. Uma leitura vai ao ar no instante em que chega; as que
+// chegam antes do intervalo, ou sem orçamento na task do rádio (reenvios,
+// mudança de SF), são puladas em vez de atrasadas.
+#ifndef LORA_TX_PERIOD_MS
+#define LORA_TX_PERIOD_MS 1000
+#endif
 
-// Variáveis globais publicadas pela task_sensores.h
-extern volatile float temp_aht;
-extern volatile float umid_aht;
-extern volatile float pressao_bmp;
+// Modos de reporte
+#define LORA_MODE_PERIODIC  0   // Uma leitura por quadro, no ritmo do orçamento de duty cycle
+#define LORA_MODE_BATCH     1   // Acumula amostras e envia várias em um só quadro
+#define LORA_MODE_DELTA     2   // Envia só quando algum canal sai da banda morta (ou no heartbeat)
 
-// Período de envio (ms)
-#ifndef LORA_TX_PERIOD_MS
-#define LORA_TX_PERIOD_MS 3000
+#ifndef LORA_REPORT_MODE
+#define LORA_REPORT_MODE LORA_MODE_PERIODIC
+#endif
+
+// O lote é enviado ao atingir LORA_BATCH_MAX_SAMPLES amostras ou quando a
+// primeira amostra fica mais velha que LORA_BATCH_MAX_AGE_MS
+#ifndef LORA_BATCH_MAX_SAMPLES
+#define LORA_BATCH_MAX_SAMPLES 10
+#endif
+#ifndef LORA_BATCH_MAX_AGE_MS
+#define LORA_BATCH_MAX_AGE_MS 15000
 #endif
 
-// Tentativas de reenvio em caso de falha
-#define LORA_TX_RETRY 1
+// Banda morta por canal do modo por variação, nas unidades do quadro
+#ifndef LORA_DEADBAND_TEMP_CDEG
+#define LORA_DEADBAND_TEMP_CDEG 20      // 0,2 °C
+#endif
+#ifndef LORA_DEADBAND_HUM_CPCT
+#define LORA_DEADBAND_HUM_CPCT 100      // 1 %
+#endif
+#ifndef LORA_DEADBAND_PRESS_PA
+#define LORA_DEADBAND_PRESS_PA 50       // 0,5 hPa
+#endif
 
-static inline int is_valid_float(float v) {
-    return (v == v) && (v != (float)1e300) && (v != -(float)1e300); // checagem simples p/ NaN/Inf
+// Intervalo máximo sem envio no modo por variação (sinal de vida)
+#ifndef LORA_HEARTBEAT_MS
+#define LORA_HEARTBEAT_MS (5 * 60 * 1000)
+#endif
+
+#if LORA_BATCH_MAX_SAMPLES > TELEMETRY_BATCH_MAX
+#error "LORA_BATCH_MAX_SAMPLES maior que TELEMETRY_BATCH_MAX"
+#endif
+
+// Conclusão de cada quadro, chamada na task do rádio
+static void lora_tx_done(uint32_t frame_id, radio_tx_status_t status) {
+    radio_tx_stats_t st;
+    radio_get_tx_stats(&st);
+    if (status == RADIO_TX_OK) {
+        printf("[LoRaTX] Quadro %lu enviado: %lu ms no ar, orçamento livre %lu ms "
+               "(fila %lu, descartes %lu)\n",
+               (unsigned long)frame_id, (unsigned long)st.airtime_last_ms,
+               (unsigned long)st.airtime_remaining_ms, (unsigned long)st.depth,
+               (unsigned long)st.dropped);
+
+        energy_report_t e;
+        radio_energy_report(&e);
+        uint32_t hours = energy_battery_hours(&e, RADIO_BATTERY_MAH);
+        printf("[Energia] Ciclo de %lu ms: média %lu.%02lu mA (rádio %lu uC, MCU %lu uC; "
+               "TX %lu ms, RX %lu ms, MCU dormindo %lu ms), autonomia ~%lu h com %u mAh\n",
+               (unsigned long)e.period_ms, (unsigned long)(e.avg_ua / 1000),
+               (unsigned long)(e.avg_ua % 1000 / 10), (unsigned long)e.radio_uc,
+               (unsigned long)e.mcu_uc, (unsigned long)e.radio_ms[ENERGY_RADIO_TX],
+               (unsigned long)(e.radio_ms[ENERGY_RADIO_RX] + e.radio_ms[ENERGY_RADIO_CAD]),
+               (unsigned long)e.mcu_idle_ms, (unsigned long)hours, RADIO_BATTERY_MAH);
+    } else if (status == RADIO_TX_NO_ACK) {
+        printf("[LoRaTX] ERRO: quadro %lu sem confirmação do receptor (%lu reenvios no total).\n",
+               (unsigned long)frame_id, (unsigned long)st.retransmissions);
+    } else {
+        printf("[LoRaTX] ERRO: quadro %lu não confirmado após retries.\n",
+               (unsigned long)frame_id);
+    }
 }
 
+// Algum canal se afastou do último valor enviado além da banda morta?
+static inline bool lora_delta_exceeded(const telemetry_sample_t *now, const telemetry_sample_t *sent) {
+    int32_t dt = (int32_t)now->temp_cdeg - sent->temp_cdeg;
+    int32_t dh = (int32_t)now->humidity_cpct - sent->humidity_cpct;
+    int32_t dp = (int32_t)now->pressure_pa - (int32_t)sent->pressure_pa;
+    return (dt >= LORA_DEADBAND_TEMP_CDEG || -dt >= LORA_DEADBAND_TEMP_CDEG) ||
+           (dh >= LORA_DEADBAND_HUM_CPCT  || -dh >= LORA_DEADBAND_HUM_CPCT)  ||
+           (dp >= LORA_DEADBAND_PRESS_PA  || -dp >= LORA_DEADBAND_PRESS_PA);
+}
+
+// Entrega o quadro à fila do rádio sem bloquear durante o tempo no ar.
+// 'sample_ms' é o instante da leitura mais recente do quadro. Retorna o id
+// do quadro ou 0 se ele não entrou na fila.
+static uint32_t lora_submit(const uint8_t *payload, size_t n, uint16_t seq, uint32_t sample_ms) {
+    if (n == 0) {
+        printf("[LoRaTX] ERRO: quadro não coube no buffer.\n");
+        return 0;
+    }
+    uint32_t id = radio_send_async(payload, (uint8_t)n, lora_tx_done);
+    if (id == 0) {
+        printf("[LoRaTX] Fila do rádio cheia, quadro descartado.\n");
+    } else {
+        uint32_t age = to_ms_since_boot(get_absolute_time()) - sample_ms;
+        printf("[LoRaTX] Quadro %lu na fila: seq %u, %u bytes, leitura de %lu ms atrás\n",
+               (unsigned long)id, seq, (unsigned)n, (unsigned long)age);
+    }
+    return id;
+}
+
+// Quadro binário em ponto fixo (12 bytes, contra ~20 do CSV "TS,%.2f,%.2f,%.2f")
+static uint32_t lora_send_reading(const snapshot_record_t *leitura, uint16_t seq,
+                                uint8_t *payload, size_t payload_len) {
+    telemetry_reading_t r = {
+        .node_id = LORA_NODE_ID,
+        .seq = seq,
+        .flags = leitura->flags,
+        .temp_cdeg = leitura->sample.temp_cdeg,
+        .humidity_cpct = leitura->sample.humidity_cpct,
+        .pressure_pa = leitura->sample.pressure_pa,
+    };
+    size_t n = telemetry_encode(&r, payload, payload_len);
+    return lora_submit(payload, n, seq, leitura->timestamp_ms);
+}
+
+#if LORA_REPORT_MODE == LORA_MODE_BATCH
+// Envia o lote aberto e começa outro ('sample_ms': instante da última amostra)
+static void lora_batch_flush(telemetry_batch_t *batch, uint8_t *payload, size_t payload_len,
+                             uint32_t sample_ms) {
+    size_t n = telemetry_encode_batch(batch, payload, payload_len);
+    lora_submit(payload, n, batch->seq_first, sample_ms);
+    batch->count = 0;
+}
+#endif
+
 void vTaskLoRaTX(void *pvParameters) {
     (void)pvParameters;
 
     printf("[LoRaTX] Iniciando transmissor...\n");
-    if (!sx127x_init()) {                 // tua lib já faz toda a config de rádio/pinos
-        printf("[LoRaTX] ERRO: SX1276 não detectado.\n");
-        vTaskDelete(NULL);
-    }
-    printf("[LoRaTX] Pronto para transmitir.\n");
 
-    uint32_t seq = 0;
-    char payload[96];
+    uint16_t seq = 0;
+    uint32_t last_sample = 0;         // Publicação da última leitura recebida
+    uint32_t skipped = 0;             // Leituras perdidas na fila ou puladas
+#if LORA_REPORT_MODE == LORA_MODE_BATCH
+    static telemetry_batch_t batch;   // Fora da pilha da task (~130 bytes)
+    uint8_t payload[TELEMETRY_BATCH_MAX_LEN];
+    uint32_t batch_start_ms = 0;
+    uint32_t batch_last_ms = 0;       // Instante da última amostra do lote
+    batch.node_id = LORA_NODE_ID;
+    batch.interval_ms = SENSORES_PERIOD_MS;
+#else
+    uint8_t payload[TELEMETRY_READING_LEN];
+#endif
+#if LORA_REPORT_MODE == LORA_MODE_DELTA
+    telemetry_sample_t last_sent;
+    uint32_t last_sent_ms = 0;
+    bool have_sent = false;
+#elif LORA_REPORT_MODE != LORA_MODE_BATCH
+    uint32_t last_tx_sample = 0;      // Publicação da última leitura enviada
+#endif
 
     for (;;) {
-        // snapshot das leituras (evita inconsistência durante o printf/snprintf)
-        float ta = temp_aht;
-        float ua = umid_aht;
-        float pb = pressao_bmp; // kPa no teu código
-
-        // (opcional) sanity check
-        if (!is_valid_float(ta) || !is_valid_float(ua) || !is_valid_float(pb)) {
-            printf("[LoRaTX] Leituras inválidas, pulando envio.\n");
-            vTaskDelay(pdMS_TO_TICKS(500));
-            continue;
+        // Acorda só com leitura nova; nada de polling
+        snapshot_record_t leitura;
+        xQueueReceive(sensores_lora_queue, &leitura, portMAX_DELAY);
+        if (last_sample && leitura.seq - last_sample > 1) {
+            skipped += leitura.seq - last_sample - 1;
+            printf("[LoRaTX] %lu leituras descartadas pela fila (total %lu).\n",
+                   (unsigned long)(leitura.seq - last_sample - 1), (unsigned long)skipped);
         }
-
-        // CSV compacto: TAG,TempAHT,UmidAHT,Press_kPa,SEQ
-        // Ex.: TS,25.31,61.20,100.84,123
-        int n = snprintf(payload, sizeof(payload),
-                         "TS,%.2f,%.2f,%.2f",
-                         ta, ua, pb);
-
-        if (n <= 0 || n >= (int)sizeof(payload)) {
-            printf("[LoRaTX] ERRO: payload maior que o buffer (%d).\n", n);
-            vTaskDelay(pdMS_TO_TICKS(1000));
+#if LORA_REPORT_MODE == LORA_MODE_BATCH
+        // O lote declara amostras espaçadas de interval_ms: uma leitura
+        // perdida ou inválida fecha o lote aberto em vez de deixar um buraco
+        bool gap = leitura.flags == 0 || (last_sample && leitura.seq - last_sample > 1);
+        if (gap && batch.count) lora_batch_flush(&batch, payload, sizeof(payload), batch_last_ms);
+#endif
+        last_sample = leitura.seq;
+        if (leitura.flags == 0) {
+            printf("[LoRaTX] Sem leitura válida, pulando envio.\n");
             continue;
         }
 
-        bool ok = sx127x_send_message(payload);
-        if (!ok) {
-            printf("[LoRaTX] Falha no envio, tentando novamente...\n");
-            for (int i = 0; i < LORA_TX_RETRY && !ok; i++) {
-                vTaskDelay(pdMS_TO_TICKS(300));   // pequeno backoff
-                ok = sx127x_send_message(payload);
-            }
+#if LORA_REPORT_MODE == LORA_MODE_BATCH
+        // Preâmbulo e cabeçalho LoRa divididos entre todas as amostras do lote
+        if (batch.count == 0) {
+            batch.seq_first = seq;
+            batch.flags = TELEMETRY_FLAG_AHT_OK | TELEMETRY_FLAG_BMP_OK;
+            batch_start_ms = leitura.timestamp_ms;
         }
-
-        if (ok) {
-            printf("[LoRaTX] Enviado: %s\n", payload);
-        } else {
-            printf("[LoRaTX] ERRO: envio não confirmado após retries.\n");
+        batch.flags &= leitura.flags;       // Um canal só vale se valeu no lote todo
+        batch.samples[batch.count++] = leitura.sample;
+        batch_last_ms = leitura.timestamp_ms;
+        seq++;
+
+        bool full = batch.count >= LORA_BATCH_MAX_SAMPLES;
+        bool old = (leitura.timestamp_ms - batch_start_ms) >= LORA_BATCH_MAX_AGE_MS;
+        if (full || old) lora_batch_flush(&batch, payload, sizeof(payload), leitura.timestamp_ms);
+#elif LORA_REPORT_MODE == LORA_MODE_DELTA
+        // Em regime estável só o heartbeat vai ao ar. A referência só anda
+        // se o quadro entrou na fila: descartado, a variação é reenviada na
+        // próxima leitura
+        bool heartbeat = !have_sent || (leitura.timestamp_ms - last_sent_ms) >= LORA_HEARTBEAT_MS;
+        if ((heartbeat || lora_delta_exceeded(&leitura.sample, &last_sent)) &&
+            lora_send_reading(&leitura, seq++, payload, sizeof(payload)) != 0) {
+            last_sent = leitura.sample;
+            last_sent_ms = leitura.timestamp_ms;
+            have_sent = true;
         }
-
-        vTaskDelay(pdMS_TO_TICKS(LORA_TX_PERIOD_MS));
+#else
+        // Envia já ou pula: a leitura nunca espera pelo orçamento. O
+        // intervalo acompanha o SF atual (o ADR pode mudá-lo).
+        uint32_t interval = radio_tx_interval_ms(TELEMETRY_READING_LEN);
+        if (interval < LORA_TX_PERIOD_MS) interval = LORA_TX_PERIOD_MS;
+        uint32_t every = (interval + SENSORES_PERIOD_MS - 1) / SENSORES_PERIOD_MS;
+        bool early = last_tx_sample && leitura.seq - last_tx_sample < every;
+        if (early) continue;
+        if (radio_tx_wait_ms(TELEMETRY_READING_LEN) > 0) {
+            printf("[LoRaTX] Sem orçamento de tempo no ar, leitura pulada (total %lu).\n",
+                   (unsigned long)++skipped);
+            continue;
+        }
+        lora_send_reading(&leitura, seq++, payload, sizeof(payload));
+        last_tx_sample = leitura.seq;
+#endif
     }
 }
 
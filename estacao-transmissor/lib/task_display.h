@@ -5,12 +5,9 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "hardware/i2c.h"
+#include "i2c_bus/i2c_bus.h"
 #include "ssd1306/ssd1306.h"
-
-// Variáveis globais dos sensores
-extern volatile float temp_aht;
-extern volatile float umid_aht;
-extern volatile float pressao_bmp;
+#include "task_sensores.h"  // leituras entregues por sensores_display_queue
 
 // I2C do display
 #define I2C_PORT_DISP i2c1
@@ -19,26 +16,37 @@ extern volatile float pressao_bmp;
 #define DISPLAY_ADDR 0x3C
 
 void vTaskDisplay(void *pvParameters) {
-    // Inicializa o barramento I2C1 para o display
-    i2c_init(I2C_PORT_DISP, 400 * 1000);
-    gpio_set_function(SDA_DISP, GPIO_FUNC_I2C);
-    gpio_set_function(SCL_DISP, GPIO_FUNC_I2C);
-    gpio_pull_up(SDA_DISP);
-    gpio_pull_up(SCL_DISP);
+    // Inicializa o barramento I2C1 para o display (framebuffer enviado por DMA)
+    i2c_bus_init(I2C_PORT_DISP, 400 * 1000, SDA_DISP, SCL_DISP);
 
     // Inicializa o display SSD1306
     ssd1306_t ssd;
     ssd1306_init(&ssd, WIDTH, HEIGHT, false, DISPLAY_ADDR, I2C_PORT_DISP);
     ssd1306_config(&ssd);
 
-    char str_tempAHT[8], str_umi[8], str_pressao[8];
+    char str_tempAHT[8], str_umi[8], str_pressao[12], str_tempBMP[8];
+    snapshot_record_t leitura;
     bool cor = true;
 
     while (1) {
+        // Redesenha só quando chega leitura nova (a fila guarda apenas a última)
+        xQueueReceive(sensores_display_queue, &leitura, portMAX_DELAY);
+
         // Converte dados para string
-        sprintf(str_tempAHT, "%.1fC", temp_aht);
-        sprintf(str_umi, "%.1f%%", umid_aht);
-        sprintf(str_pressao, "%.1fKPa", pressao_bmp);
+        if (leitura.flags & TELEMETRY_FLAG_AHT_OK) {
+            snprintf(str_tempAHT, sizeof(str_tempAHT), "%.1fC", leitura.sample.temp_cdeg / 100.0f);
+            snprintf(str_umi, sizeof(str_umi), "%.1f%%", leitura.sample.humidity_cpct / 100.0f);
+        } else {
+            snprintf(str_tempAHT, sizeof(str_tempAHT), "ND");
+            snprintf(str_umi, sizeof(str_umi), "ND");
+        }
+        if (leitura.flags & TELEMETRY_FLAG_BMP_OK) {
+            snprintf(str_pressao, sizeof(str_pressao), "%.1fKPa", leitura.sample.pressure_pa / 1000.0f);
+            snprintf(str_tempBMP, sizeof(str_tempBMP), "%.1fC", leitura.bmp_temp_cdeg / 100.0f);
+        } else {
+            snprintf(str_pressao, sizeof(str_pressao), "ND");
+            snprintf(str_tempBMP, sizeof(str_tempBMP), "ND");
+        }
 
         // Atualiza display com bordas e layout
         ssd1306_fill(&ssd, !cor);                        // Limpa com inversão
@@ -60,10 +68,9 @@ void vTaskDisplay(void *pvParameters) {
 
         // Dados AHT20 (direita)
         ssd1306_draw_string(&ssd, str_pressao, 66, 43);
-        ssd1306_draw_string(&ssd, "ND", 66, 53);
+        ssd1306_draw_string(&ssd, str_tempBMP, 66, 53);
 
         ssd1306_send_data(&ssd);
-        vTaskDelay(pdMS_TO_TICKS(1000)); // Atualiza a cada 2s
     }
 }
 
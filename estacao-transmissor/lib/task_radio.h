@@ -0,0 +1,730 @@
+// task_radio.h — task dona do rádio LoRa e fila de transmissão assíncrona
+#ifndef TASK_RADIO_H
+#define TASK_RADIO_H
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "sx127x.h"
+#include "duty_cycle.h"
+#include "telemetry.h"
+#include "arq.h"
+#include "tdma.h"
+#include "energy.h"
+
+// Identificador desta estação (uplinks e comandos endereçados a ela)
+#ifndef LORA_NODE_ID
+#define LORA_NODE_ID 1
+#endif
+
+// Quantidade de quadros aguardando transmissão
+#ifndef RADIO_TX_QUEUE_LEN
+#define RADIO_TX_QUEUE_LEN 8
+#endif
+
+// Maior payload aceito pela fila (bytes): o FIFO inteiro do SX1276
+#define RADIO_TX_MAX_LEN 255
+
+// Folga sobre o tempo no ar do quadro aguardando o TxDone no DIO0 (ms); o
+// tempo no ar já segue o SF do ADR e o preâmbulo do sniff
+#ifndef RADIO_TX_MARGIN_MS
+#define RADIO_TX_MARGIN_MS 100
+#endif
+
+// Tentativas de reenvio em caso de falha
+#define RADIO_TX_RETRY 1
+
+// Limite de ocupação do canal: RADIO_DUTY_PERMILLE por mil sobre a janela
+// deslizante (10 = 1%, 100 = 10%)
+#ifndef RADIO_DUTY_WINDOW_MS
+#define RADIO_DUTY_WINDOW_MS (60 * 60 * 1000)
+#endif
+#ifndef RADIO_DUTY_PERMILLE
+#define RADIO_DUTY_PERMILLE 10
+#endif
+
+// Janela de recepção aberta após cada TxDone para comandos ADR do receptor:
+// o comando precisa começar até RADIO_RX_WINDOW_MS depois do fim do uplink
+// (0 desliga a janela e o ADR)
+#ifndef RADIO_RX_WINDOW_MS
+#define RADIO_RX_WINDOW_MS 200
+#endif
+
+// Sem comando por RADIO_ADR_ACK_LIMIT uplinks, o nó pede resposta
+// (TELEMETRY_FLAG_ADR_ACK_REQ); sem resposta por mais RADIO_ADR_ACK_DELAY
+// uplinks, volta ao perfil padrão, onde o receptor também acaba procurando
+#define RADIO_ADR_ACK_LIMIT 32
+#define RADIO_ADR_ACK_DELAY 8
+
+// Entrega confirmada: cada quadro pede TELEMETRY_TYPE_ACK na janela de
+// recepção e é reenviado com backoff (ver arq.h) até ser confirmado.
+// O callback só é chamado na confirmação ou ao esgotar as tentativas.
+// Exige RADIO_RX_WINDOW_MS > 0.
+#ifndef RADIO_ACK_MODE
+#define RADIO_ACK_MODE 0
+#endif
+
+// Slots sincronizados pelo beacon do receptor (ver tdma.h): cada quadro sai
+// no slot do nó, e os beacons são escutados na hora prevista mesmo sem nada
+// a enviar. Sem beacon (ou sem slot) o envio é aleatório com jitter, e o nó
+// procura o beacon por RADIO_TDMA_SCAN_MS a cada RADIO_TDMA_SCAN_INTERVAL_MS
+// (os quadros esperam na fila durante a procura). Exige LORA_TDMA no receptor.
+#ifndef RADIO_TDMA
+#define RADIO_TDMA 0
+#endif
+#ifndef RADIO_TDMA_SCAN_MS
+#define RADIO_TDMA_SCAN_MS 12000    // Um pouco mais que o período do beacon
+#endif
+#ifndef RADIO_TDMA_SCAN_INTERVAL_MS
+#define RADIO_TDMA_SCAN_INTERVAL_MS 60000
+#endif
+
+// Listen-before-talk: antes de cada transmissão o rádio faz CAD; com o canal
+// ocupado espera um tempo aleatório de 1 a 2^n tempos do próprio quadro (n =
+// detecções seguidas) e tenta de novo. Depois de RADIO_LBT_MAX_BUSY detecções
+// transmite mesmo assim, para não segurar a fila indefinidamente. No próprio
+// slot TDMA o CAD é pulado: o canal é do nó e a espera perderia o slot.
+#ifndef RADIO_LBT
+#define RADIO_LBT 0
+#endif
+#ifndef RADIO_LBT_MAX_BUSY
+#define RADIO_LBT_MAX_BUSY 5
+#endif
+
+// Saltos de frequência: cada quadro sai no canal do plano (SX127X_CHANNEL_PLAN)
+// dado pela sequência compartilhada sx127x_hop_channel(nó, primeira sequência
+// do quadro); reenvios usam o canal da próxima sequência nova, onde o receptor
+// espera o nó. A janela de resposta fica no mesmo canal do uplink e, com
+// RADIO_TDMA, os beacons ficam no canal 0. Exige LORA_HOPPING no receptor e
+// um plano de vários canais (o padrão, SX127X_PLAN_SINGLE, não salta).
+#ifndef RADIO_HOPPING
+#define RADIO_HOPPING 0
+#endif
+
+// Baixo consumo: o SX1276 dorme (MODE_SLEEP) sempre que a task fica à espera
+// de quadros, orçamento ou slot, em vez de ficar em standby; junto com o
+// tickless idle (FreeRTOSConfig.h) o MCU também dorme até o próximo prazo.
+// O consumo estimado de cada ciclo sai em radio_energy_report().
+#ifndef RADIO_LOW_POWER
+#define RADIO_LOW_POWER 1
+#endif
+
+// Capacidade da bateria usada na estimativa de autonomia (mAh)
+#ifndef RADIO_BATTERY_MAH
+#define RADIO_BATTERY_MAH 2000
+#endif
+
+typedef enum {
+    RADIO_TX_OK = 0,      // TxDone recebido
+    RADIO_TX_FAILED,      // Sem TxDone após todas as tentativas
+    RADIO_TX_TOO_LONG,    // Tempo no ar maior que o orçamento da janela
+    RADIO_TX_NO_ACK,      // RADIO_ACK_MODE: sem confirmação após ARQ_MAX_ATTEMPTS envios
+} radio_tx_status_t;
+
+// Chamado na task do rádio quando o quadro termina (com sucesso ou não)
+typedef void (*radio_tx_callback_t)(uint32_t frame_id, radio_tx_status_t status);
+
+typedef struct {
+    uint32_t id;
+    radio_tx_callback_t callback;
+    uint8_t len;
+    uint8_t data[RADIO_TX_MAX_LEN];
+} radio_tx_frame_t;
+
+typedef struct {
+    uint32_t queued;      // Quadros aceitos na fila
+    uint32_t sent;        // Quadros concluídos com TxDone
+    uint32_t failed;      // Quadros que esgotaram as tentativas
+    uint32_t dropped;     // Quadros recusados (fila cheia ou tamanho inválido)
+    uint32_t depth;       // Ocupação atual da fila
+    uint32_t depth_max;   // Maior ocupação observada
+    uint32_t airtime_last_ms;       // Tempo no ar do último quadro
+    uint32_t airtime_remaining_ms;  // Orçamento de tempo no ar ainda livre na janela
+    uint32_t duty_wait_ms;          // Tempo total retido pelo limite de duty cycle
+    uint32_t adr_commands;          // Comandos ADR recebidos e aplicados
+    uint32_t adr_fallbacks;         // Retornos ao perfil padrão por falta de resposta
+    uint32_t acked;                 // RADIO_ACK_MODE: quadros confirmados pelo receptor
+    uint32_t retransmissions;       // RADIO_ACK_MODE: reenvios por falta de confirmação
+    uint32_t ack_expired;           // RADIO_ACK_MODE: quadros abandonados sem confirmação
+    uint32_t cad_attempts;          // RADIO_LBT: detecções de atividade feitas
+    uint32_t cad_busy;              // RADIO_LBT: canal encontrado ocupado
+    uint32_t lbt_forced;            // RADIO_LBT: envios com o canal ainda ocupado
+    uint32_t lbt_wait_ms;           // RADIO_LBT: latência total somada pelas esperas
+    uint32_t beacons;               // RADIO_TDMA: beacons recebidos
+    uint32_t beacons_lost;          // RADIO_TDMA: janelas de beacon sem recepção
+    int32_t drift_ppm;              // RADIO_TDMA: deriva estimada do relógio local
+    bool slotted;                   // RADIO_TDMA: sincronizado e com slot atribuído
+} radio_tx_stats_t;
+
+static QueueHandle_t radio_tx_queue = NULL;
+static TaskHandle_t radio_task = NULL;
+static radio_tx_stats_t radio_stats;
+static uint32_t radio_next_id = 1;
+static duty_cycle_t radio_duty;
+static sx127x_profile_t radio_profile;  // Perfil ativo, lido pelos produtores (seção crítica)
+static uint16_t radio_adr_silence = 0;   // Uplinks desde o último comando ADR
+static uint32_t radio_rng;               // Estado do gerador das esperas do LBT
+static uint16_t radio_hop_next;          // Próxima sequência nova (canal dos reenvios)
+static bool radio_hop_started = false;
+
+// Tempo em cada estado do rádio e do MCU para a estimativa de consumo. Só a
+// task do rádio e a idle task (com o escalonador suspenso) alteram: num
+// único núcleo uma nunca interrompe a outra.
+static energy_t radio_energy;
+static uint64_t radio_idle_start_us;
+
+// Quadros aguardando confirmação e o callback de cada slot (só a task do rádio
+// altera; os contadores são lidos por radio_get_tx_stats())
+static arq_t radio_arq;
+static radio_tx_callback_t radio_arq_callback[ARQ_SLOTS];
+
+// Sincronismo com o beacon (só a task do rádio altera)
+static tdma_t radio_tdma;
+static uint32_t radio_tdma_scan_ms;     // Última procura sem sincronismo
+
+static inline uint32_t radio_now_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+// Registra a troca de estado do rádio na estimativa de consumo
+static void radio_power(energy_radio_state_t state) {
+    sx127x_profile_t profile;
+    sx127x_get_profile(&profile);
+    energy_radio(&radio_energy, state, profile.tx_power_dbm, time_us_64());
+}
+
+// Entre ciclos o rádio dorme (ou fica em standby sem RADIO_LOW_POWER)
+static void radio_idle(void) {
+    if (!RADIO_LOW_POWER || radio_energy.radio_state == ENERGY_RADIO_SLEEP) return;
+    sx127x_sleep();
+    radio_power(ENERGY_RADIO_SLEEP);
+}
+
+// Ganchos do tickless idle (traceLOW_POWER_IDLE_BEGIN/END em FreeRTOSConfig.h)
+void radio_mcu_idle_begin(void) {
+    radio_idle_start_us = time_us_64();
+}
+
+void radio_mcu_idle_end(void) {
+    energy_mcu_idle(&radio_energy, time_us_64() - radio_idle_start_us);
+}
+
+// Fecha o ciclo de consumo (desde o relatório anterior); chamar na task do
+// rádio, por exemplo no callback de conclusão do quadro
+void radio_energy_report(energy_report_t *out) {
+    energy_cycle(&radio_energy, time_us_64(), out);
+}
+
+// Tempo no ar (ms, arredondado para cima) de um payload no perfil ativo. Os
+// produtores também chamam, então lê a cópia que a task do rádio atualiza
+// em radio_configure(), não o perfil do driver
+static uint32_t radio_airtime_ms(uint8_t len) {
+    taskENTER_CRITICAL();
+    sx127x_profile_t profile = radio_profile;
+    taskEXIT_CRITICAL();
+    return (sx127x_time_on_air_us(&profile, len) + 999) / 1000;
+}
+
+// Cria a fila; chamar em main() antes de criar as tasks produtoras
+void radio_tx_queue_init(void) {
+    radio_tx_queue = xQueueCreate(RADIO_TX_QUEUE_LEN, sizeof(radio_tx_frame_t));
+    configASSERT(radio_tx_queue != NULL);
+    duty_cycle_init(&radio_duty, RADIO_DUTY_WINDOW_MS, RADIO_DUTY_PERMILLE, radio_now_ms());
+    radio_profile = sx127x_profile_default;   // Até a task do rádio aplicar o perfil
+    arq_init(&radio_arq, LORA_NODE_ID * 2654435761u);
+    tdma_init(&radio_tdma, LORA_NODE_ID * 2246822519u);
+    radio_rng = LORA_NODE_ID * 3266489917u;
+}
+
+// Quanto um produtor deve esperar para que mais um quadro de 'len' bytes
+// caiba no orçamento, contando os quadros que já estão na fila
+uint32_t radio_tx_wait_ms(uint8_t len) {
+    uint32_t pending = radio_tx_queue ? uxQueueMessagesWaiting(radio_tx_queue) : 0;
+    uint32_t airtime = radio_airtime_ms(len) * (pending + 1);
+    taskENTER_CRITICAL();
+    uint32_t wait = duty_cycle_wait_ms(&radio_duty, radio_now_ms(), airtime);
+    taskEXIT_CRITICAL();
+    return wait;
+}
+
+// Intervalo entre quadros de 'len' bytes que espalha o orçamento por igual
+// pela janela (tempo no ar / duty cycle): enviando mais rápido o orçamento
+// acaba no início da janela e o nó fica mudo até o fim dela
+uint32_t radio_tx_interval_ms(uint8_t len) {
+    return radio_airtime_ms(len) * 1000u / RADIO_DUTY_PERMILLE;
+}
+
+// Enfileira um quadro sem bloquear. Retorna o id do quadro ou 0 se foi descartado.
+uint32_t radio_send_async(const uint8_t *buf, uint8_t len, radio_tx_callback_t callback) {
+    if (len == 0 || radio_tx_queue == NULL) {   // len (uint8_t) nunca passa de RADIO_TX_MAX_LEN
+        taskENTER_CRITICAL();
+        radio_stats.dropped++;
+        taskEXIT_CRITICAL();
+        return 0;
+    }
+
+    radio_tx_frame_t frame;
+    frame.callback = callback;
+    frame.len = len;
+    memcpy(frame.data, buf, len);
+
+    taskENTER_CRITICAL();
+    frame.id = radio_next_id++;
+    if (radio_next_id == 0) radio_next_id = 1;  // 0 é reservado para "descartado"
+    taskEXIT_CRITICAL();
+
+    if (xQueueSend(radio_tx_queue, &frame, 0) != pdPASS) {
+        taskENTER_CRITICAL();
+        radio_stats.dropped++;
+        taskEXIT_CRITICAL();
+        return 0;
+    }
+
+    uint32_t depth = uxQueueMessagesWaiting(radio_tx_queue);
+    taskENTER_CRITICAL();
+    radio_stats.queued++;
+    if (depth > radio_stats.depth_max) radio_stats.depth_max = depth;
+    taskEXIT_CRITICAL();
+    return frame.id;
+}
+
+// Cópia consistente das estatísticas da fila
+void radio_get_tx_stats(radio_tx_stats_t *out) {
+    taskENTER_CRITICAL();
+    *out = radio_stats;
+    out->airtime_remaining_ms = duty_cycle_remaining_ms(&radio_duty, radio_now_ms());
+    out->acked = radio_arq.acked;
+    out->retransmissions = radio_arq.retransmissions;
+    out->ack_expired = radio_arq.expired;
+    out->beacons = radio_tdma.beacons;
+    out->beacons_lost = radio_tdma.lost;
+    out->drift_ppm = radio_tdma.drift_ppm;
+    out->slotted = tdma_has_slot(&radio_tdma);
+    taskEXIT_CRITICAL();
+    out->depth = radio_tx_queue ? uxQueueMessagesWaiting(radio_tx_queue) : 0;
+}
+
+static void radio_dio0_isr(void) {
+    BaseType_t woken = pdFALSE;
+    if (radio_task) vTaskNotifyGiveFromISR(radio_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+// Segura a transmissão até o orçamento de duty cycle comportar 'airtime_ms'
+static bool radio_wait_budget(uint32_t airtime_ms) {
+    for (;;) {
+        taskENTER_CRITICAL();
+        uint32_t wait = duty_cycle_wait_ms(&radio_duty, radio_now_ms(), airtime_ms);
+        taskEXIT_CRITICAL();
+        if (wait == 0) return true;
+        if (wait == UINT32_MAX) return false;
+
+        taskENTER_CRITICAL();
+        radio_stats.duty_wait_ms += wait;
+        taskEXIT_CRITICAL();
+        radio_idle();
+        vTaskDelay(pdMS_TO_TICKS(wait));
+    }
+}
+
+// Escuta até 'until_ms' (relógio local) por um beacon do receptor; outros
+// pacotes (respostas a outros nós) são ignorados. Retorna true se recebeu.
+static bool radio_beacon_listen(uint32_t until_ms) {
+    uint8_t buf[TELEMETRY_BEACON_MAX_LEN + 1];
+    sx127x_packet_t pkt;
+    telemetry_beacon_t b;
+    bool got = false;
+
+    if (RADIO_HOPPING) sx127x_set_channel(0);
+    ulTaskNotifyTake(pdTRUE, 0);
+    sx127x_start_rx();
+    radio_power(ENERGY_RADIO_RX);
+    for (int32_t left; !got && (left = (int32_t)(until_ms - radio_now_ms())) > 0; ) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(left));
+        uint8_t flags = sx127x_take_irq_flags();
+        if (!(flags & SX127X_IRQ_RX_DONE)) continue;
+        if (!sx127x_read_packet(flags, buf, sizeof(buf), &pkt)) continue;
+        if (!telemetry_decode_beacon(buf, pkt.len, &b)) continue;
+
+        // O DIO0 marca o fim do pacote, o mesmo instante que o relógio do
+        // receptor no beacon
+        tdma_on_beacon(&radio_tdma, (uint32_t)(pkt.timestamp_us / 1000), b.gateway_ms, b.period_ms,
+                       b.slot_ms, b.offset_ms, telemetry_beacon_slot(&b, LORA_NODE_ID));
+        got = true;
+    }
+    sx127x_standby();
+    radio_power(ENERGY_RADIO_STANDBY);
+    return got;
+}
+
+// Início (relógio local) da janela do próximo beacon: a janela cobre o
+// tempo no ar do maior beacon mais a margem de deriva
+static uint32_t radio_beacon_window_start(uint32_t now_ms) {
+    uint32_t end = tdma_next_beacon(&radio_tdma, now_ms);
+    return end - radio_airtime_ms(TELEMETRY_BEACON_MAX_LEN) - tdma_beacon_guard_ms(&radio_tdma);
+}
+
+// Escuta o beacon previsto ou procura um sem sincronismo, quando for a hora.
+// Retorna quanto falta (ms) para a próxima escuta (UINT32_MAX sem RADIO_TDMA).
+static uint32_t radio_tdma_poll(void) {
+    if (!RADIO_TDMA) return UINT32_MAX;
+
+    uint32_t now = radio_now_ms();
+    if (radio_tdma.synced) {
+        int32_t wait = (int32_t)(radio_beacon_window_start(now) - now);
+        if (wait > 0) return (uint32_t)wait;
+        bool was_slotted = tdma_has_slot(&radio_tdma);
+        uint32_t end = tdma_next_beacon(&radio_tdma, now) + tdma_beacon_guard_ms(&radio_tdma);
+        if (!radio_beacon_listen(end)) {
+            tdma_beacon_missed(&radio_tdma);
+            if (!radio_tdma.synced) {
+                radio_tdma_scan_ms = radio_now_ms();
+                printf("[Radio] Beacon perdido, voltando ao acesso aleatório.\n");
+            }
+        } else if (tdma_has_slot(&radio_tdma) != was_slotted) {
+            printf("[Radio] TDMA: %s.\n", was_slotted ? "slot retirado" : "slot atribuído");
+        }
+        return 0;
+    }
+
+    uint32_t since = now - radio_tdma_scan_ms;
+    if (radio_tdma.beacons + radio_tdma.lost > 0 && since < RADIO_TDMA_SCAN_INTERVAL_MS) {
+        return RADIO_TDMA_SCAN_INTERVAL_MS - since;
+    }
+    if (radio_beacon_listen(now + RADIO_TDMA_SCAN_MS)) {
+        printf("[Radio] TDMA: sincronizado, slot %d de %u ms (deriva %ld ppm).\n", radio_tdma.slot,
+               radio_tdma.slot_ms, (long)radio_tdma.drift_ppm);
+    } else {
+        tdma_beacon_missed(&radio_tdma);
+    }
+    radio_tdma_scan_ms = radio_now_ms();
+    return 0;
+}
+
+// Segura a transmissão até o slot do nó (ou o jitter do acesso aleatório),
+// escutando antes o beacon que vier no caminho. 'busy_ms' inclui a resposta.
+static void radio_wait_slot(uint32_t busy_ms) {
+    if (!RADIO_TDMA) return;
+
+    for (;;) {
+        uint32_t now = radio_now_ms();
+        uint32_t at = tdma_tx_time(&radio_tdma, now, busy_ms);
+        uint32_t window = radio_tdma.synced ? radio_beacon_window_start(now) : 0;
+        if (radio_tdma.synced && (int32_t)(window - (at + busy_ms)) < 0) {
+            int32_t to_window = (int32_t)(window - now);
+            if (to_window > 0) {
+                radio_idle();
+                vTaskDelay(pdMS_TO_TICKS(to_window));
+            }
+            radio_tdma_poll();
+            continue;
+        }
+        int32_t wait = (int32_t)(at - now);
+        if (wait > 0) {
+            radio_idle();
+            vTaskDelay(pdMS_TO_TICKS(wait));
+        }
+        return;
+    }
+}
+
+// xorshift32: espera aleatória do LBT, diferente em cada nó
+static uint32_t radio_rand(void) {
+    radio_rng ^= radio_rng << 13;
+    radio_rng ^= radio_rng >> 17;
+    radio_rng ^= radio_rng << 5;
+    return radio_rng;
+}
+
+// Uma detecção de atividade no canal; dorme até o CadDone no DIO0.
+// Sem CadDone (borda perdida) considera o canal livre.
+static bool radio_channel_busy(void) {
+    sx127x_profile_t profile;
+    sx127x_get_profile(&profile);
+    uint32_t timeout_ms = 4 * sx127x_symbol_time_us(&profile) / 1000 + 2;
+
+    ulTaskNotifyTake(pdTRUE, 0);
+    sx127x_start_cad();
+    radio_power(ENERGY_RADIO_CAD);
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms));
+    uint8_t flags = sx127x_take_irq_flags();
+    sx127x_standby();
+    radio_power(ENERGY_RADIO_STANDBY);
+
+    bool busy = (flags & SX127X_IRQ_CAD_DONE) && (flags & SX127X_IRQ_CAD_DETECTED);
+    taskENTER_CRITICAL();
+    radio_stats.cad_attempts++;
+    if (busy) radio_stats.cad_busy++;
+    taskEXIT_CRITICAL();
+    return busy;
+}
+
+// Espera o canal ficar livre com backoff exponencial aleatório
+static void radio_listen_before_talk(uint32_t airtime_ms) {
+    if (!RADIO_LBT || tdma_has_slot(&radio_tdma)) return;
+
+    uint32_t start = radio_now_ms();
+    int busy = 0;
+    while (radio_channel_busy()) {
+        if (++busy > RADIO_LBT_MAX_BUSY) {
+            taskENTER_CRITICAL();
+            radio_stats.lbt_forced++;
+            taskEXIT_CRITICAL();
+            break;
+        }
+        uint32_t window = (airtime_ms ? airtime_ms : 1) << busy;
+        vTaskDelay(pdMS_TO_TICKS(1 + radio_rand() % window));
+    }
+
+    taskENTER_CRITICAL();
+    radio_stats.lbt_wait_ms += radio_now_ms() - start;
+    taskEXIT_CRITICAL();
+}
+
+// Sintoniza o canal do quadro na sequência de saltos
+static void radio_hop(const uint8_t *data, uint8_t len) {
+    if (!RADIO_HOPPING) return;
+
+    uint16_t seq_first;
+    uint8_t count;
+    uint16_t seq = radio_hop_next;
+    if (telemetry_frame_seq(data, len, &seq_first, &count) &&
+        (!radio_hop_started || (int16_t)(seq_first - radio_hop_next) >= 0)) {
+        seq = seq_first;
+        radio_hop_next = (uint16_t)(seq_first + count);
+        radio_hop_started = true;
+    }
+    sx127x_set_channel(sx127x_hop_channel(LORA_NODE_ID, seq));
+}
+
+// Inicia a transmissão e dorme (sem consumir CPU) até o DIO0 sinalizar TxDone
+static bool radio_transmit(const uint8_t *data, uint8_t len) {
+    uint32_t airtime = radio_airtime_ms(len);
+    if (!radio_wait_budget(airtime)) return false;
+    radio_wait_slot(airtime + (RADIO_RX_WINDOW_MS ? radio_airtime_ms(TELEMETRY_DOWNLINK_MAX_LEN) : 0));
+    radio_hop(data, len);
+    radio_listen_before_talk(airtime);
+
+    ulTaskNotifyTake(pdTRUE, 0);  // Descarta notificação pendente de um ciclo anterior
+    if (!sx127x_start_tx(data, len)) return false;
+    radio_power(ENERGY_RADIO_TX);
+
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(airtime + RADIO_TX_MARGIN_MS));
+    uint8_t flags = sx127x_take_irq_flags();  // Também cobre uma borda perdida (timeout)
+    radio_power(ENERGY_RADIO_STANDBY);        // Depois do TxDone o rádio volta sozinho a standby
+
+    // Mesmo sem TxDone o canal pode ter sido ocupado: conta o tempo no ar
+    taskENTER_CRITICAL();
+    duty_cycle_record(&radio_duty, radio_now_ms(), airtime);
+    radio_stats.airtime_last_ms = airtime;
+    taskEXIT_CRITICAL();
+    return (flags & SX127X_IRQ_TX_DONE) != 0;
+}
+
+// Aplica um perfil com o preâmbulo longo do sniff (SX127X_SNIFF_PERIOD_MS),
+// recalculado para o SF/BW do perfil a partir do preâmbulo padrão
+static bool radio_configure(const sx127x_profile_t *profile) {
+    sx127x_profile_t p = *profile;
+    p.preamble_len = sx127x_profile_default.preamble_len;
+    p.preamble_len = sx127x_sniff_preamble_len(&p, SX127X_SNIFF_PERIOD_MS);
+    if (!sx127x_configure(&p)) return false;
+    taskENTER_CRITICAL();
+    radio_profile = p;
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+// Aplica SF e potência comandados pelo receptor (o restante do perfil não muda)
+static bool radio_apply_adr(uint8_t sf, int8_t tx_power_dbm) {
+    sx127x_profile_t profile;
+    sx127x_get_profile(&profile);
+    if (profile.sf == sf && profile.tx_power_dbm == tx_power_dbm) return true;
+    profile.sf = sf;
+    profile.tx_power_dbm = tx_power_dbm;
+    if (!radio_configure(&profile)) {
+        printf("[Radio] Comando ADR inválido (SF%u, %d dBm), ignorado.\n", sf, tx_power_dbm);
+        return false;
+    }
+    printf("[Radio] ADR: SF%u, %d dBm.\n", sf, tx_power_dbm);
+    return true;
+}
+
+// Conclusão de um quadro confirmado ou abandonado pelo ARQ
+static void radio_arq_done(const arq_slot_t *slot, arq_result_t result, void *user) {
+    (void)user;
+    radio_tx_callback_t cb = radio_arq_callback[slot - radio_arq.slots];
+    if (cb) cb(slot->id, result == ARQ_ACKED ? RADIO_TX_OK : RADIO_TX_NO_ACK);
+}
+
+// Trata o que o receptor mandou na janela: comando ADR ou confirmação
+// (que pode trazer um comando ADR junto). Retorna false se não era para este nó.
+static bool radio_handle_downlink(const uint8_t *buf, uint8_t len) {
+    telemetry_adr_t cmd;
+    telemetry_ack_t ack;
+    bool adr = false;
+    uint8_t sf = 0;
+    int8_t power = 0;
+
+    if (telemetry_decode_adr(buf, len, &cmd)) {
+        if (cmd.node_id != LORA_NODE_ID) return false;
+        adr = true;
+        sf = cmd.sf;
+        power = cmd.tx_power_dbm;
+    } else if (telemetry_decode_ack(buf, len, &ack)) {
+        if (ack.node_id != LORA_NODE_ID) return false;
+        arq_ack(&radio_arq, ack.last_seq, ack.bitmap, radio_arq_done, NULL);
+        adr = ack.has_adr;
+        sf = ack.sf;
+        power = ack.tx_power_dbm;
+    } else {
+        return false;
+    }
+
+    if (adr && radio_apply_adr(sf, power)) {
+        taskENTER_CRITICAL();
+        radio_stats.adr_commands++;
+        taskEXIT_CRITICAL();
+    }
+    return true;
+}
+
+// Escuta o receptor logo após o uplink. A janela cobre o atraso de resposta
+// mais o tempo no ar da maior resposta no perfil atual.
+static void radio_rx_window(void) {
+    if (RADIO_RX_WINDOW_MS == 0) return;
+
+    uint32_t window = RADIO_RX_WINDOW_MS + radio_airtime_ms(TELEMETRY_DOWNLINK_MAX_LEN);
+    ulTaskNotifyTake(pdTRUE, 0);
+    sx127x_start_rx();
+    radio_power(ENERGY_RADIO_RX);
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(window));
+    uint8_t flags = sx127x_take_irq_flags();
+
+    uint8_t buf[TELEMETRY_DOWNLINK_MAX_LEN + 1];
+    sx127x_packet_t pkt;
+    bool got = (flags & SX127X_IRQ_RX_DONE) &&
+               sx127x_read_packet(flags, buf, sizeof(buf), &pkt) &&
+               radio_handle_downlink(buf, pkt.len);
+    sx127x_standby();
+    radio_power(ENERGY_RADIO_STANDBY);
+
+    if (got) {
+        radio_adr_silence = 0;
+        return;
+    }
+
+    // Perdeu o receptor: depois do pedido sem resposta, volta ao ponto de encontro
+    if (++radio_adr_silence >= RADIO_ADR_ACK_LIMIT + RADIO_ADR_ACK_DELAY) {
+        radio_adr_silence = RADIO_ADR_ACK_LIMIT;   // Continua pedindo resposta
+        sx127x_profile_t profile;
+        sx127x_get_profile(&profile);
+        if (profile.sf != sx127x_profile_default.sf ||
+            profile.tx_power_dbm != sx127x_profile_default.tx_power_dbm) {
+            radio_configure(&sx127x_profile_default);
+            taskENTER_CRITICAL();
+            radio_stats.adr_fallbacks++;
+            taskEXIT_CRITICAL();
+            printf("[Radio] ADR sem resposta, voltando ao perfil padrão.\n");
+        }
+    }
+}
+
+// Reenvia um quadro do ARQ (já marcado com TELEMETRY_FLAG_ACK_REQ)
+static void radio_retransmit(int slot) {
+    const arq_slot_t *s = &radio_arq.slots[slot];
+    printf("[Radio] Reenviando quadro %lu (tentativa %u).\n", (unsigned long)s->id, s->attempts + 1);
+    bool ok = radio_transmit(s->data, s->len);
+
+    arq_resent(&radio_arq, slot, radio_now_ms());
+    if (ok) radio_rx_window();
+}
+
+// Única task que acessa o SX1276: esvazia a fila um quadro após o outro
+void vTaskRadio(void *pvParameters) {
+    (void)pvParameters;
+
+    printf("[Radio] Iniciando SX1276...\n");
+    if (!sx127x_init() || !radio_configure(&sx127x_profile_default)) {
+        printf("[Radio] ERRO: SX1276 não detectado.\n");
+        vTaskDelete(NULL);
+    }
+    radio_task = xTaskGetCurrentTaskHandle();
+    energy_init(&radio_energy, ENERGY_RADIO_STANDBY, time_us_64());
+    sx127x_set_dio0_callback(radio_dio0_isr);
+    printf("[Radio] Pronto (SPI %lu Hz).\n", (unsigned long)sx127x_get_spi_baud());
+
+    radio_tx_frame_t frame;
+    for (;;) {
+        // Beacon previsto tem prioridade; sem nada a enviar, a task acorda
+        // a tempo da próxima janela
+        uint32_t wait = radio_tdma_poll();
+        if (wait == 0) continue;
+
+        // Reenvios vencidos têm prioridade sobre quadros novos
+        if (RADIO_ACK_MODE) {
+            arq_expire(&radio_arq, radio_now_ms(), radio_arq_done, NULL);
+            uint32_t due;
+            int slot = arq_next_due(&radio_arq, radio_now_ms(), &due);
+            if (due < wait) wait = due;
+            if (slot >= 0) {
+                radio_retransmit(slot);
+                continue;
+            }
+        }
+
+        // Com todos os slots do ARQ ocupados, novos quadros esperam na fila
+        TickType_t block = wait == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(wait);
+        if (RADIO_ACK_MODE && arq_full(&radio_arq)) {
+            radio_idle();
+            vTaskDelay(block ? block : 1);
+            continue;
+        }
+        // Nada na fila: o rádio dorme até o próximo quadro ou prazo
+        if (uxQueueMessagesWaiting(radio_tx_queue) == 0) radio_idle();
+        if (xQueueReceive(radio_tx_queue, &frame, block) != pdPASS) continue;
+
+        if (radio_airtime_ms(frame.len) > radio_duty.budget_ms) {
+            taskENTER_CRITICAL();
+            radio_stats.failed++;
+            taskEXIT_CRITICAL();
+            if (frame.callback) frame.callback(frame.id, RADIO_TX_TOO_LONG);
+            continue;
+        }
+
+        if (RADIO_RX_WINDOW_MS && radio_adr_silence >= RADIO_ADR_ACK_LIMIT) {
+            telemetry_set_flags(frame.data, frame.len, TELEMETRY_FLAG_ADR_ACK_REQ);
+        }
+        uint16_t seq_first = 0;
+        uint8_t seq_count = 0;
+        bool want_ack = RADIO_ACK_MODE && telemetry_frame_seq(frame.data, frame.len, &seq_first, &seq_count) &&
+                        telemetry_set_flags(frame.data, frame.len, TELEMETRY_FLAG_ACK_REQ);
+
+        bool ok = radio_transmit(frame.data, frame.len);
+        for (int i = 0; i < RADIO_TX_RETRY && !ok; i++) {
+            vTaskDelay(pdMS_TO_TICKS(300));   // pequeno backoff
+            ok = radio_transmit(frame.data, frame.len);
+        }
+
+        taskENTER_CRITICAL();
+        if (ok) radio_stats.sent++;
+        else    radio_stats.failed++;
+        taskEXIT_CRITICAL();
+
+        // Guardado antes da janela: o ACK pode chegar nela
+        if (ok && want_ack) {
+            int slot = arq_track(&radio_arq, frame.data, frame.len, seq_first, seq_count,
+                                 frame.id, NULL, radio_now_ms());
+            if (slot >= 0) radio_arq_callback[slot] = frame.callback;
+            want_ack = slot >= 0;
+        }
+        if (ok) radio_rx_window();
+
+        if (!(ok && want_ack) && frame.callback) frame.callback(frame.id, ok ? RADIO_TX_OK : RADIO_TX_FAILED);
+    }
+}
+
+#endif // TASK_RADIO_H
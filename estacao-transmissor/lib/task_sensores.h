@@ -4,15 +4,34 @@
 #include "pico/stdlib.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#include "queue.h"
 #include "hardware/i2c.h"
+#include "i2c_bus/i2c_bus.h"
 #include "aht20/aht20.h"
 #include "bmp280/bmp280.h"
+#include "snapshot/snapshot_record.h"
 #include <math.h>
 
-// --- Variáveis globais com os dados dos sensores ---
-volatile float temp_aht = 0.0f;
-volatile float umid_aht = 0.0f;
-volatile float pressao_bmp = 0.0f;
+// Período de amostragem (ms), fixo a partir do primeiro ciclo
+#ifndef SENSORES_PERIOD_MS
+#define SENSORES_PERIOD_MS 1000
+#endif
+
+// Leituras aguardando a task LoRa. Com a fila cheia a mais antiga é
+// descartada (contada em sensores_lora_dropped): a amostragem nunca espera
+// pelo rádio e o que vai ao ar é sempre o mais recente.
+#ifndef SENSORES_LORA_QUEUE_LEN
+#define SENSORES_LORA_QUEUE_LEN 4
+#endif
+
+// Pipeline sensores -> LoRa/display: cada leitura (snapshot_record_t, todos
+// os canais do mesmo ciclo) é copiada para as duas filas no fim do ciclo e as
+// tasks consumidoras acordam na hora. O display só quer a última (fila de 1
+// posição sobrescrita). Não há leitor por polling, então o seqlock do
+// snapshot não entra no transmissor: as filas já entregam cópias consistentes.
+QueueHandle_t sensores_lora_queue = NULL;
+QueueHandle_t sensores_display_queue = NULL;
+volatile uint32_t sensores_lora_dropped = 0;
 
 // --- I2C e parâmetros ---
 #define SDA_I2C0 0
@@ -20,45 +39,106 @@ volatile float pressao_bmp = 0.0f;
 #define I2C_PORT i2c0
 #define SEA_LEVEL_PRESSURE 101325.0
 
+// BMP280 em modo forçado: uma medição por ciclo e sleep entre elas
+static const bmp280_config_t bmp_config = {
+    .mode = BMP280_MODE_FORCED,
+    .osrs_t = BMP280_OSRS_X1,
+    .osrs_p = BMP280_OSRS_X4,
+    .filter = BMP280_FILTER_4,
+    .standby = BMP280_STANDBY_0_5_MS,          // Não usado no modo forçado
+};
+
+// Cria as filas do pipeline; chamar antes de criar as tasks
+void sensores_queues_init(void) {
+    sensores_lora_queue = xQueueCreate(SENSORES_LORA_QUEUE_LEN, sizeof(snapshot_record_t));
+    sensores_display_queue = xQueueCreate(1, sizeof(snapshot_record_t));
+    configASSERT(sensores_lora_queue != NULL && sensores_display_queue != NULL);
+}
+
+// Numera a leitura (a task LoRa detecta descartes pelos saltos) e entrega
+// às filas sem bloquear
+static void sensores_publish(snapshot_record_t *leitura) {
+    leitura->seq++;
+    if (xQueueSend(sensores_lora_queue, leitura, 0) != pdPASS) {
+        snapshot_record_t antiga;
+        xQueueReceive(sensores_lora_queue, &antiga, 0);
+        xQueueSend(sensores_lora_queue, leitura, 0);
+        sensores_lora_dropped++;
+    }
+    xQueueOverwrite(sensores_display_queue, leitura);
+}
+
 // --- Task de leitura dos sensores ---
 void vTaskSensores(void *pvParameters) {
-    // Inicialização I2C0 
-    i2c_init(I2C_PORT, 400 * 1000);
-    gpio_set_function(SDA_I2C0, GPIO_FUNC_I2C);
-    gpio_set_function(SCL_I2C0, GPIO_FUNC_I2C);
-    gpio_pull_up(SDA_I2C0);
-    gpio_pull_up(SCL_I2C0);
+    // Inicialização I2C0 (mutex e DMA do barramento no i2c_bus)
+    i2c_bus_init(I2C_PORT, 400 * 1000, SDA_I2C0, SCL_I2C0);
 
 
     // Inicialização dos sensores
-    bmp280_init(I2C_PORT);
+    bmp280_configure(I2C_PORT, &bmp_config);
     struct bmp280_calib_param calib;
     bmp280_get_calib_params(I2C_PORT, &calib);
 
+    // AHT20: as esperas do datasheet cedem a CPU em vez de ocupar a task
     aht20_reset(I2C_PORT);
-    sleep_ms(50);
+    vTaskDelay(pdMS_TO_TICKS(AHT20_RESET_MS));
     aht20_init(I2C_PORT);
+    vTaskDelay(pdMS_TO_TICKS(AHT20_INIT_MS));
+    if (!aht20_is_calibrated(I2C_PORT)) {
+        printf("AHT20 sem calibração\n");
+    }
 
     AHT20_Data dados_aht;
+    bmp280_measurement_t medida_bmp;
     int32_t raw_temp, raw_press;
+    snapshot_record_t leitura = { 0 };
+
+    // As duas conversões correm juntas; a espera é a da mais longa
+    uint32_t conversao_ms = (bmp280_measure_time_us(&bmp_config) + 999) / 1000;
+    if (conversao_ms < AHT20_MEASURE_MS) conversao_ms = AHT20_MEASURE_MS;
 
+    TickType_t ciclo = xTaskGetTickCount();
     while (1) {
-        // BMP280
-        bmp280_read_raw(I2C_PORT, &raw_temp, &raw_press);
-        pressao_bmp = bmp280_convert_pressure(raw_press, raw_temp, &calib) / 1000.0;
+        // Dispara AHT20 e BMP280 e bloqueia até o fim das conversões
+        TickType_t disparo = xTaskGetTickCount();
+        leitura.timestamp_ms = to_ms_since_boot(get_absolute_time());
+        leitura.flags = 0;
+        bool aht_disparado = aht20_trigger(I2C_PORT);
+        bmp280_trigger(I2C_PORT, &bmp_config);
+        vTaskDelayUntil(&disparo, pdMS_TO_TICKS(conversao_ms));
+
+        // BMP280: t_fine calculado uma vez para temperatura e pressão
+        if (bmp280_is_measuring(I2C_PORT)) {
+            printf("BMP280 ainda convertendo\n");
+        } else {
+            bmp280_read_raw(I2C_PORT, &raw_temp, &raw_press);
+            if (bmp280_compensate(raw_temp, raw_press, &calib, &medida_bmp)) {
+                leitura.bmp_temp_cdeg = (int16_t)medida_bmp.temp_cdeg;
+                leitura.sample.pressure_pa = (medida_bmp.pressure_q8 + 128) >> 8;   // Q24.8 -> Pa
+                leitura.flags |= TELEMETRY_FLAG_BMP_OK;
+            }
+        }
 
         // AHT20
-        if (aht20_read(I2C_PORT, &dados_aht)) {
-            temp_aht = dados_aht.temperature;
-            umid_aht = dados_aht.humidity;
+        aht20_result_t aht = aht_disparado ? aht20_fetch(I2C_PORT, &dados_aht) : AHT20_ERROR;
+        for (int i = 0; i < AHT20_FETCH_RETRIES && aht == AHT20_BUSY; i++) {
+            vTaskDelay(pdMS_TO_TICKS(AHT20_RETRY_MS));
+            aht = aht20_fetch(I2C_PORT, &dados_aht);
+        }
+        if (aht == AHT20_READY) {
+            leitura.sample.temp_cdeg = (int16_t)lroundf(dados_aht.temperature * 100.0f);
+            leitura.sample.humidity_cpct = (uint16_t)lroundf(dados_aht.humidity * 100.0f);
+            leitura.flags |= TELEMETRY_FLAG_AHT_OK;
         } else {
             printf("Falha na leitura do AHT20\n");
         }
 
-        printf("AHT20: %.1f °C, %.1f %% | BMP280: %.2f kPa\n",
-            temp_aht, umid_aht, pressao_bmp);
+        sensores_publish(&leitura);
+        printf("AHT20: %.1f °C, %.1f %% | BMP280: %.1f °C, %.3f kPa\n",
+            leitura.sample.temp_cdeg / 100.0f, leitura.sample.humidity_cpct / 100.0f,
+            leitura.bmp_temp_cdeg / 100.0f, leitura.sample.pressure_pa / 1000.0f);
 
-        vTaskDelay(pdMS_TO_TICKS(1000)); // espera 1s
+        vTaskDelayUntil(&ciclo, pdMS_TO_TICKS(SENSORES_PERIOD_MS));
     }
 }
 
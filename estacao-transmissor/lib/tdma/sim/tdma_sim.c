@@ -0,0 +1,168 @@
+// tdma_sim.c — simulação no host dos slots sincronizados por beacon (tdma.c)
+// com relógio simulado: cada nó tem o seu cristal com deriva fixa em ppm e o
+// canal considera perdido todo quadro que se sobrepõe a outro no receptor.
+//
+// Compilar e rodar (Linux):
+//   gcc -O2 -I.. -o tdma_sim tdma_sim.c ../tdma.c && ./tdma_sim [perda_de_beacon]
+//
+// Para cada número de nós mostra a entrega com acesso aleatório puro e com
+// TDMA, quantos quadros no TDMA saíram fora do próprio slot (no relógio do
+// receptor) e quantos saíram por acesso aleatório sem sincronismo.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "tdma.h"
+
+#define SIM_FRAMES        2000    // Superquadros simulados
+#define SIM_PERIOD_MS     10000   // Um beacon e um quadro por nó a cada 10 s
+#define SIM_SLOT_MS       280     // Tempo no ar + janela de RX + margens
+#define SIM_OFFSET_MS     100     // Slot 0 após o fim do beacon
+#define SIM_AIRTIME_MS    41      // SF7, 12 B
+#define SIM_BEACON_MS     72      // SF7, beacon com 32 slots
+#define SIM_DRIFT_PPM     50      // Deriva máxima dos cristais dos nós
+#define SIM_MAX_NODES     32
+
+typedef struct {
+    uint32_t start;
+    uint32_t end;
+    bool beacon;
+} sim_tx_t;
+
+static uint32_t sim_rng = 12345;
+
+static uint32_t sim_rand(void) {
+    sim_rng ^= sim_rng << 13;
+    sim_rng ^= sim_rng >> 17;
+    sim_rng ^= sim_rng << 5;
+    return sim_rng;
+}
+
+static double sim_uniform(void) {
+    return (sim_rand() & 0xFFFFFF) / (double)0x1000000;
+}
+
+typedef struct {
+    tdma_t tdma;
+    double ppm;               // Deriva real do cristal
+    double offset_ms;         // Relógio local no instante 0 do receptor
+    uint32_t busy_until;      // Fim da transmissão anterior (relógio local)
+} sim_node_t;
+
+static uint32_t sim_local(const sim_node_t *n, double gw_ms) {
+    return (uint32_t)(n->offset_ms + gw_ms * (1.0 + n->ppm / 1e6));
+}
+
+static double sim_gateway(const sim_node_t *n, uint32_t local_ms) {
+    return ((double)local_ms - n->offset_ms) / (1.0 + n->ppm / 1e6);
+}
+
+static int sim_cmp(const void *a, const void *b) {
+    const sim_tx_t *x = a, *y = b;
+    return (x->start > y->start) - (x->start < y->start);
+}
+
+// Conta os quadros que não se sobrepõem a nenhum outro
+static uint32_t sim_delivered(sim_tx_t *tx, uint32_t n) {
+    qsort(tx, n, sizeof(*tx), sim_cmp);
+    uint32_t ok = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        bool hit = (i > 0 && tx[i - 1].end > tx[i].start) ||
+                   (i + 1 < n && tx[i + 1].start < tx[i].end);
+        // Quadros mais longos que o vizinho anterior também podem cobrir o seguinte
+        for (uint32_t j = i; !hit && j-- > 0 && i - j < 4; ) {
+            if (tx[j].end > tx[i].start) hit = true;
+        }
+        if (!hit && !tx[i].beacon) ok++;
+    }
+    return ok;
+}
+
+typedef struct {
+    double delivery;
+    uint32_t outside_slot;
+    uint32_t random_access;
+} sim_result_t;
+
+static sim_result_t sim_run(int nodes, bool use_tdma, double beacon_loss) {
+    static sim_tx_t tx[SIM_FRAMES * (SIM_MAX_NODES + 1)];
+    sim_node_t node[SIM_MAX_NODES];
+    sim_result_t r = {0};
+    uint32_t n_tx = 0;
+
+    for (int i = 0; i < nodes; i++) {
+        tdma_init(&node[i].tdma, (uint32_t)(i + 1) * 2654435761u);
+        node[i].ppm = (sim_uniform() * 2 - 1) * SIM_DRIFT_PPM;
+        node[i].offset_ms = sim_uniform() * 1e6;
+        node[i].busy_until = 0;
+    }
+
+    for (uint32_t k = 1; k <= SIM_FRAMES; k++) {
+        double beacon_gw = (double)k * SIM_PERIOD_MS;
+        for (int i = 0; i < nodes; i++) {
+            sim_node_t *n = &node[i];
+            if (use_tdma) {
+                if (sim_uniform() >= beacon_loss) {
+                    // Jitter de até 1 ms na detecção do fim do pacote
+                    uint32_t rx = sim_local(n, beacon_gw + sim_uniform());
+                    tdma_on_beacon(&n->tdma, rx, (uint32_t)beacon_gw, SIM_PERIOD_MS,
+                                   SIM_SLOT_MS, SIM_OFFSET_MS, i);
+                } else {
+                    tdma_beacon_missed(&n->tdma);
+                }
+            }
+
+            // Quadro pronto num instante qualquer do superquadro
+            double ready_gw = beacon_gw + sim_uniform() * (SIM_PERIOD_MS - SIM_BEACON_MS);
+            uint32_t ready = sim_local(n, ready_gw);
+            // O rádio só pega o quadro depois de terminar o anterior
+            if ((int32_t)(n->busy_until - ready) > 0) ready = n->busy_until;
+            uint32_t at = ready;
+            if (use_tdma) {
+                bool slotted = tdma_has_slot(&n->tdma);
+                at = tdma_tx_time(&n->tdma, ready, SIM_AIRTIME_MS);
+                if (!slotted) {
+                    r.random_access++;
+                }
+            }
+            n->busy_until = at + SIM_AIRTIME_MS;
+            double start = sim_gateway(n, at);
+            if (use_tdma && tdma_has_slot(&n->tdma)) {
+                // Posição dentro do superquadro do receptor
+                double phase = start - (uint32_t)(start / SIM_PERIOD_MS) * (double)SIM_PERIOD_MS;
+                double slot = SIM_OFFSET_MS + i * SIM_SLOT_MS;
+                if (phase < slot || phase + SIM_AIRTIME_MS > slot + SIM_SLOT_MS) r.outside_slot++;
+            }
+            tx[n_tx].start = (uint32_t)(start * 10);
+            tx[n_tx].end = (uint32_t)((start + SIM_AIRTIME_MS) * 10);
+            tx[n_tx].beacon = false;
+            n_tx++;
+        }
+        // Beacons também ocupam o canal
+        if (use_tdma) {
+            tx[n_tx].start = (uint32_t)((beacon_gw - SIM_BEACON_MS) * 10);
+            tx[n_tx].end = (uint32_t)(beacon_gw * 10);
+            tx[n_tx].beacon = true;
+            n_tx++;
+        }
+    }
+
+    uint32_t frames = SIM_FRAMES * (uint32_t)nodes;
+    r.delivery = 100.0 * sim_delivered(tx, n_tx) / frames;
+    return r;
+}
+
+int main(int argc, char **argv) {
+    double beacon_loss = argc > 1 ? atof(argv[1]) : 0.1;
+    const int counts[] = {1, 4, 8, 16, 24, 32};
+
+    printf("perda de beacon %.0f%%, %d superquadros de %d ms, slot %d ms\n\n",
+           beacon_loss * 100, SIM_FRAMES, SIM_PERIOD_MS, SIM_SLOT_MS);
+    printf("nós  aleatório  tdma     fora_do_slot  acesso_aleatório\n");
+    for (unsigned i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        sim_result_t aloha = sim_run(counts[i], false, 0);
+        sim_result_t tdma = sim_run(counts[i], true, beacon_loss);
+        printf("%3d  %8.1f%%  %6.1f%%  %12u  %16u\n", counts[i], aloha.delivery,
+               tdma.delivery, tdma.outside_slot, tdma.random_access);
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "tdma.h"
+#include <string.h>
+
+// xorshift32: jitter barato e determinístico a partir da semente
+static uint32_t tdma_rand(tdma_t *t) {
+    uint32_t x = t->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    t->rng = x;
+    return x;
+}
+
+void tdma_init(tdma_t *t, uint32_t seed) {
+    memset(t, 0, sizeof(*t));
+    t->slot = -1;
+    t->rng = seed ? seed : 0x9E3779B9u;
+}
+
+void tdma_on_beacon(tdma_t *t, uint32_t local_ms, uint32_t gw_ms, uint16_t period_ms,
+                    uint16_t slot_ms, uint16_t offset_ms, int slot) {
+    // Com resolução de 1 ms, medir entre beacons vizinhos (10 s) daria passos
+    // de 100 ppm: o erro cai com o intervalo desde a âncora. O relógio do
+    // receptor no beacon dispensa contar os beacons perdidos.
+    int32_t dl = (int32_t)(local_ms - t->anchor_local_ms);
+    int32_t dg = (int32_t)(gw_ms - t->anchor_gw_ms);
+    // Só troca a estimativa por outra medida num intervalo ao menos tão longo
+    // (ou longo o bastante para ~1 ppm, depois de renovar a âncora)
+    uint32_t min_span = t->drift_span_ms < TDMA_ANCHOR_MAX_MS / 4 ? t->drift_span_ms : TDMA_ANCHOR_MAX_MS / 4;
+    if (min_span < TDMA_ANCHOR_MIN_MS) min_span = TDMA_ANCHOR_MIN_MS;
+    if (t->beacons == 0 || dg < 0) {
+        // Primeiro beacon ou receptor reiniciado
+        t->anchor_local_ms = local_ms;
+        t->anchor_gw_ms = gw_ms;
+    } else if ((uint32_t)dg >= min_span) {
+        int32_t ppm = (int32_t)((int64_t)(dl - dg) * 1000000 / dg);
+        if (ppm <= TDMA_DRIFT_MAX_PPM && ppm >= -TDMA_DRIFT_MAX_PPM) {
+            t->drift_ppm = ppm;
+            t->drift_span_ms = (uint32_t)dg;
+            t->has_drift = true;
+        }
+        if ((uint32_t)dg >= TDMA_ANCHOR_MAX_MS || !t->has_drift) {
+            // Nova âncora: a estimativa atual vale até a próxima ficar pronta
+            t->anchor_local_ms = local_ms;
+            t->anchor_gw_ms = gw_ms;
+        }
+    }
+
+    t->ref_local_ms = local_ms;
+    t->ref_gw_ms = gw_ms;
+    t->period_ms = period_ms;
+    t->slot_ms = slot_ms;
+    t->offset_ms = offset_ms;
+    t->slot = (int16_t)slot;
+    t->missed = 0;
+    t->synced = true;
+    t->beacons++;
+}
+
+void tdma_beacon_missed(tdma_t *t) {
+    t->lost++;
+    if (!t->synced) return;
+    if (++t->missed >= TDMA_MAX_MISSED) {
+        // A âncora continua valendo para medir a deriva na volta
+        t->synced = false;
+    }
+}
+
+bool tdma_has_slot(const tdma_t *t) {
+    return t->synced && t->slot >= 0;
+}
+
+uint32_t tdma_to_local(const tdma_t *t, uint32_t gw_ms) {
+    int32_t dg = (int32_t)(gw_ms - t->ref_gw_ms);
+    int64_t corr = (int64_t)dg * t->drift_ppm / 1000000;
+    return t->ref_local_ms + (uint32_t)(dg + (int32_t)corr);
+}
+
+uint32_t tdma_to_gateway(const tdma_t *t, uint32_t local_ms) {
+    int32_t dl = (int32_t)(local_ms - t->ref_local_ms);
+    int64_t corr = (int64_t)dl * t->drift_ppm / (1000000 + t->drift_ppm);
+    return t->ref_gw_ms + (uint32_t)(dl - (int32_t)corr);
+}
+
+// Número do superquadro que contém 'now_ms' (0 = o do último beacon)
+static int32_t tdma_frame_index(const tdma_t *t, uint32_t now_ms) {
+    int32_t dg = (int32_t)(tdma_to_gateway(t, now_ms) - t->ref_gw_ms);
+    int32_t k = dg / (int32_t)t->period_ms;
+    if (dg < 0 && k * (int32_t)t->period_ms != dg) k--;
+    return k;
+}
+
+uint32_t tdma_next_beacon(const tdma_t *t, uint32_t now_ms) {
+    int32_t k = tdma_frame_index(t, now_ms) + 1;
+    return tdma_to_local(t, t->ref_gw_ms + (uint32_t)(k * (int32_t)t->period_ms));
+}
+
+uint32_t tdma_beacon_guard_ms(const tdma_t *t) {
+    // Sem estimativa de deriva, considera o pior caso do cristal a cada período
+    uint32_t per_frame = t->has_drift ? 1 : (uint32_t)t->period_ms * TDMA_DRIFT_MAX_PPM / 1000000 + 1;
+    return TDMA_GUARD_MS + per_frame * (t->missed + 1) * 2;
+}
+
+uint32_t tdma_tx_time(tdma_t *t, uint32_t now_ms, uint32_t airtime_ms) {
+    if (!tdma_has_slot(t)) {
+        return now_ms + tdma_rand(t) % TDMA_ALOHA_JITTER_MS;
+    }
+
+    // Início útil do slot, já com a margem de entrada
+    uint32_t start = (uint32_t)t->offset_ms + (uint32_t)t->slot * t->slot_ms + TDMA_GUARD_MS;
+    // Se o quadro não cabe no slot, transmite no início dele mesmo assim:
+    // ultrapassa só o slot seguinte, em vez de nunca transmitir
+    bool late_ok = airtime_ms + 2 * TDMA_GUARD_MS <= t->slot_ms;
+    uint32_t latest = late_ok ? t->slot_ms - 2 * TDMA_GUARD_MS - airtime_ms : 0;
+
+    for (int32_t k = tdma_frame_index(t, now_ms); ; k++) {
+        uint32_t gw = t->ref_gw_ms + (uint32_t)(k * (int32_t)t->period_ms) + start;
+        uint32_t local = tdma_to_local(t, gw);
+        int32_t late = (int32_t)(now_ms - local);
+        if (late <= 0) return local;
+        // Já dentro do slot: transmite agora se ainda couber até o fim
+        if ((uint32_t)late <= latest) return now_ms;
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef TDMA_H
+#define TDMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Acesso ao canal por slots sincronizados pelo beacon do receptor.
+// O beacon define o superquadro: o fim da sua transmissão é a referência de
+// tempo, e o slot k do nó começa 'offset + k * slot' ms depois. O nó estima a
+// deriva do seu relógio em relação ao do receptor (ppm) pela razão entre os
+// intervalos medidos nos dois relógios desde uma âncora, e usa a estimativa
+// para prever os próximos beacons e slots, mesmo perdendo alguns.
+// Depois de TDMA_MAX_MISSED beacons perdidos seguidos (ou sem slot atribuído)
+// o nó volta ao acesso aleatório com jitter.
+// Sem dependência do SDK: o tempo (ms do relógio local) é passado pelo chamador.
+
+#define TDMA_GUARD_MS           8       // Margem em cada borda do slot e da janela do beacon
+#define TDMA_MAX_MISSED         3       // Beacons perdidos seguidos até perder o sincronismo
+#define TDMA_ALOHA_JITTER_MS    1000    // Espera aleatória máxima no acesso aleatório
+#define TDMA_DRIFT_MAX_PPM      500     // Estimativas acima disso são descartadas
+#define TDMA_ANCHOR_MIN_MS      30000   // Intervalo mínimo para a primeira estimativa
+#define TDMA_ANCHOR_MAX_MS      3600000 // Renova a âncora (acompanha a temperatura)
+
+typedef struct {
+    bool synced;
+    bool has_drift;         // Intervalo desde a âncora já basta para medir a deriva
+    int16_t slot;           // Slot do nó ou -1
+    uint8_t missed;         // Beacons perdidos desde o último recebido
+    uint16_t period_ms;
+    uint16_t slot_ms;
+    uint16_t offset_ms;
+    uint32_t ref_local_ms;  // Relógio local no fim do último beacon
+    uint32_t ref_gw_ms;     // Relógio do receptor no mesmo instante
+    uint32_t anchor_local_ms;   // Par de relógios do beacon que iniciou a medida
+    uint32_t anchor_gw_ms;
+    uint32_t drift_span_ms;     // Intervalo em que a estimativa atual foi medida
+    int32_t drift_ppm;      // > 0: relógio local adianta em relação ao receptor
+    uint32_t rng;           // Estado do gerador do jitter
+    uint32_t beacons;
+    uint32_t lost;
+} tdma_t;
+
+// 'seed' != 0 varia o jitter entre nós que compartilham o canal
+void tdma_init(tdma_t *t, uint32_t seed);
+
+// Beacon recebido: 'local_ms' é o instante local do fim da recepção e os
+// demais campos vêm do beacon; 'slot' é o do nó (-1 se não houver)
+void tdma_on_beacon(tdma_t *t, uint32_t local_ms, uint32_t gw_ms, uint16_t period_ms,
+                    uint16_t slot_ms, uint16_t offset_ms, int slot);
+
+// A janela do beacon esperado terminou sem recepção
+void tdma_beacon_missed(tdma_t *t);
+
+// Pode transmitir no próprio slot (sincronizado e com slot atribuído)
+bool tdma_has_slot(const tdma_t *t);
+
+// Conversão entre o relógio do receptor e o local, corrigida pela deriva
+uint32_t tdma_to_local(const tdma_t *t, uint32_t gw_ms);
+uint32_t tdma_to_gateway(const tdma_t *t, uint32_t local_ms);
+
+// Fim previsto (relógio local) do próximo beacon posterior a 'now_ms'
+uint32_t tdma_next_beacon(const tdma_t *t, uint32_t now_ms);
+
+// Margem da janela do beacon: cresce com os beacons perdidos, já que a
+// incerteza da deriva acumula
+uint32_t tdma_beacon_guard_ms(const tdma_t *t);
+
+// Instante local em que o nó deve começar a transmitir um quadro de
+// 'airtime_ms': o início do próximo slot próprio em que ele cabe ou, sem
+// slot, 'now_ms' mais um jitter aleatório
+uint32_t tdma_tx_time(tdma_t *t, uint32_t now_ms, uint32_t airtime_ms);
+
+#endif
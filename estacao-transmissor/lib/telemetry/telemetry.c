@@ -0,0 +1,278 @@
+#include "telemetry.h"
+#include <string.h>
+
+// === Acesso little-endian sem depender do alinhamento do buffer ===
+static inline void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put_u24(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+}
+
+static inline void put_u32(uint8_t *p, uint32_t v) {
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static inline uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get_u24(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+}
+
+static inline uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+// === Varint (LEB128) com zigzag para diferenças com sinal ===
+static inline uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+// Retorna a nova posição ou 0 se não couber
+static size_t put_varint(uint8_t *buf, size_t pos, size_t buf_len, int32_t delta) {
+    uint32_t v = zigzag(delta);
+    do {
+        if (pos >= buf_len) return 0;
+        uint8_t byte = v & 0x7F;
+        v >>= 7;
+        buf[pos++] = v ? (byte | 0x80) : byte;
+    } while (v);
+    return pos;
+}
+
+// Retorna a nova posição ou 0 se o varint estiver truncado ou for longo demais
+static size_t get_varint(const uint8_t *buf, size_t pos, size_t len, int32_t *delta) {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos >= len) return 0;
+        uint8_t byte = buf[pos++];
+        v |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *delta = unzigzag(v);
+            return pos;
+        }
+    }
+    return 0;
+}
+
+static inline uint8_t header_byte(uint8_t type) {
+    return (uint8_t)((TELEMETRY_VERSION << 4) | (type & 0x0F));
+}
+
+uint8_t telemetry_frame_type(const uint8_t *buf, size_t len) {
+    if (len == 0 || (buf[0] >> 4) != TELEMETRY_VERSION) return 0;
+    return buf[0] & 0x0F;
+}
+
+size_t telemetry_encode(const telemetry_reading_t *r, uint8_t *buf, size_t buf_len) {
+    if (buf_len < TELEMETRY_READING_LEN) return 0;
+
+    buf[0] = header_byte(TELEMETRY_TYPE_READING);
+    buf[1] = r->node_id;
+    put_u16(&buf[2], r->seq);
+    buf[4] = r->flags;
+    put_u16(&buf[5], (uint16_t)r->temp_cdeg);
+    put_u16(&buf[7], r->humidity_cpct);
+    put_u24(&buf[9], r->pressure_pa > 0xFFFFFF ? 0xFFFFFF : r->pressure_pa);
+    return TELEMETRY_READING_LEN;
+}
+
+bool telemetry_decode(const uint8_t *buf, size_t len, telemetry_reading_t *out) {
+    if (len != TELEMETRY_READING_LEN) return false;
+    if (telemetry_frame_type(buf, len) != TELEMETRY_TYPE_READING) return false;
+
+    out->node_id = buf[1];
+    out->seq = get_u16(&buf[2]);
+    out->flags = buf[4];
+    out->temp_cdeg = (int16_t)get_u16(&buf[5]);
+    out->humidity_cpct = get_u16(&buf[7]);
+    out->pressure_pa = get_u24(&buf[9]);
+    return true;
+}
+
+size_t telemetry_encode_batch(const telemetry_batch_t *b, uint8_t *buf, size_t buf_len) {
+    if (b->count == 0 || b->count > TELEMETRY_BATCH_MAX) return 0;
+    if (buf_len < TELEMETRY_BATCH_HEADER_LEN) return 0;
+
+    const telemetry_sample_t *first = &b->samples[0];
+    buf[0] = header_byte(TELEMETRY_TYPE_BATCH);
+    buf[1] = b->node_id;
+    put_u16(&buf[2], b->seq_first);
+    buf[4] = b->count;
+    put_u16(&buf[5], b->interval_ms);
+    buf[7] = b->flags;
+    put_u16(&buf[8], (uint16_t)first->temp_cdeg);
+    put_u16(&buf[10], first->humidity_cpct);
+    put_u24(&buf[12], first->pressure_pa > 0xFFFFFF ? 0xFFFFFF : first->pressure_pa);
+
+    size_t pos = TELEMETRY_BATCH_HEADER_LEN;
+    for (uint8_t i = 1; i < b->count; i++) {
+        const telemetry_sample_t *s = &b->samples[i];
+        pos = put_varint(buf, pos, buf_len, (int32_t)s->temp_cdeg - first->temp_cdeg);
+        if (pos) pos = put_varint(buf, pos, buf_len, (int32_t)s->humidity_cpct - first->humidity_cpct);
+        if (pos) pos = put_varint(buf, pos, buf_len, (int32_t)s->pressure_pa - (int32_t)first->pressure_pa);
+        if (!pos) return 0;
+    }
+    return pos;
+}
+
+bool telemetry_decode_batch(const uint8_t *buf, size_t len, telemetry_batch_t *out) {
+    if (len < TELEMETRY_BATCH_HEADER_LEN) return false;
+    if (telemetry_frame_type(buf, len) != TELEMETRY_TYPE_BATCH) return false;
+
+    out->node_id = buf[1];
+    out->seq_first = get_u16(&buf[2]);
+    out->count = buf[4];
+    out->interval_ms = get_u16(&buf[5]);
+    out->flags = buf[7];
+    if (out->count == 0 || out->count > TELEMETRY_BATCH_MAX) return false;
+
+    telemetry_sample_t *first = &out->samples[0];
+    first->temp_cdeg = (int16_t)get_u16(&buf[8]);
+    first->humidity_cpct = get_u16(&buf[10]);
+    first->pressure_pa = get_u24(&buf[12]);
+
+    size_t pos = TELEMETRY_BATCH_HEADER_LEN;
+    for (uint8_t i = 1; i < out->count; i++) {
+        int32_t dt, dh, dp;
+        pos = get_varint(buf, pos, len, &dt);
+        if (pos) pos = get_varint(buf, pos, len, &dh);
+        if (pos) pos = get_varint(buf, pos, len, &dp);
+        if (!pos) return false;
+        out->samples[i].temp_cdeg = (int16_t)(first->temp_cdeg + dt);
+        out->samples[i].humidity_cpct = (uint16_t)(first->humidity_cpct + dh);
+        out->samples[i].pressure_pa = (uint32_t)((int32_t)first->pressure_pa + dp);
+    }
+    return pos == len;
+}
+
+size_t telemetry_encode_adr(const telemetry_adr_t *a, uint8_t *buf, size_t buf_len) {
+    if (buf_len < TELEMETRY_ADR_LEN) return 0;
+
+    buf[0] = header_byte(TELEMETRY_TYPE_ADR);
+    buf[1] = a->node_id;
+    put_u16(&buf[2], a->seq);
+    buf[4] = a->sf;
+    buf[5] = (uint8_t)a->tx_power_dbm;
+    return TELEMETRY_ADR_LEN;
+}
+
+bool telemetry_decode_adr(const uint8_t *buf, size_t len, telemetry_adr_t *out) {
+    if (len != TELEMETRY_ADR_LEN) return false;
+    if (telemetry_frame_type(buf, len) != TELEMETRY_TYPE_ADR) return false;
+
+    out->node_id = buf[1];
+    out->seq = get_u16(&buf[2]);
+    out->sf = buf[4];
+    out->tx_power_dbm = (int8_t)buf[5];
+    return true;
+}
+
+size_t telemetry_encode_ack(const telemetry_ack_t *a, uint8_t *buf, size_t buf_len) {
+    size_t len = a->has_adr ? TELEMETRY_ACK_ADR_LEN : TELEMETRY_ACK_LEN;
+    if (buf_len < len) return 0;
+
+    buf[0] = header_byte(TELEMETRY_TYPE_ACK);
+    buf[1] = a->node_id;
+    put_u16(&buf[2], a->last_seq);
+    put_u32(&buf[4], a->bitmap);
+    if (a->has_adr) {
+        buf[8] = a->sf;
+        buf[9] = (uint8_t)a->tx_power_dbm;
+    }
+    return len;
+}
+
+bool telemetry_decode_ack(const uint8_t *buf, size_t len, telemetry_ack_t *out) {
+    if (len != TELEMETRY_ACK_LEN && len != TELEMETRY_ACK_ADR_LEN) return false;
+    if (telemetry_frame_type(buf, len) != TELEMETRY_TYPE_ACK) return false;
+
+    out->node_id = buf[1];
+    out->last_seq = get_u16(&buf[2]);
+    out->bitmap = get_u32(&buf[4]);
+    out->has_adr = len == TELEMETRY_ACK_ADR_LEN;
+    out->sf = out->has_adr ? buf[8] : 0;
+    out->tx_power_dbm = out->has_adr ? (int8_t)buf[9] : 0;
+    return true;
+}
+
+size_t telemetry_encode_beacon(const telemetry_beacon_t *b, uint8_t *buf, size_t buf_len) {
+    if (b->slot_count > TELEMETRY_BEACON_MAX_SLOTS) return 0;
+    size_t len = TELEMETRY_BEACON_HEADER_LEN + b->slot_count;
+    if (buf_len < len) return 0;
+
+    buf[0] = header_byte(TELEMETRY_TYPE_BEACON);
+    put_u32(&buf[1], b->gateway_ms);
+    put_u16(&buf[5], b->period_ms);
+    put_u16(&buf[7], b->slot_ms);
+    put_u16(&buf[9], b->offset_ms);
+    buf[11] = b->slot_count;
+    memcpy(&buf[12], b->slots, b->slot_count);
+    return len;
+}
+
+bool telemetry_decode_beacon(const uint8_t *buf, size_t len, telemetry_beacon_t *out) {
+    if (len < TELEMETRY_BEACON_HEADER_LEN) return false;
+    if (telemetry_frame_type(buf, len) != TELEMETRY_TYPE_BEACON) return false;
+
+    out->gateway_ms = get_u32(&buf[1]);
+    out->period_ms = get_u16(&buf[5]);
+    out->slot_ms = get_u16(&buf[7]);
+    out->offset_ms = get_u16(&buf[9]);
+    out->slot_count = buf[11];
+    if (out->slot_count > TELEMETRY_BEACON_MAX_SLOTS) return false;
+    if (len != TELEMETRY_BEACON_HEADER_LEN + (size_t)out->slot_count) return false;
+    if (out->period_ms == 0 || out->slot_ms == 0) return false;
+    memcpy(out->slots, &buf[12], out->slot_count);
+    return true;
+}
+
+int telemetry_beacon_slot(const telemetry_beacon_t *b, uint8_t node_id) {
+    for (int i = 0; i < b->slot_count; i++) {
+        if (b->slots[i] == node_id) return i;
+    }
+    return -1;
+}
+
+bool telemetry_frame_seq(const uint8_t *buf, size_t len, uint16_t *seq_first, uint8_t *count) {
+    switch (telemetry_frame_type(buf, len)) {
+    case TELEMETRY_TYPE_READING:
+        if (len != TELEMETRY_READING_LEN) return false;
+        *seq_first = get_u16(&buf[2]);
+        *count = 1;
+        return true;
+    case TELEMETRY_TYPE_BATCH:
+        if (len < TELEMETRY_BATCH_HEADER_LEN) return false;
+        *seq_first = get_u16(&buf[2]);
+        *count = buf[4];
+        return *count != 0;
+    default:
+        return false;
+    }
+}
+
+bool telemetry_set_flags(uint8_t *buf, size_t len, uint8_t flags) {
+    switch (telemetry_frame_type(buf, len)) {
+    case TELEMETRY_TYPE_READING:
+        if (len != TELEMETRY_READING_LEN) return false;
+        buf[4] |= flags;
+        return true;
+    case TELEMETRY_TYPE_BATCH:
+        if (len < TELEMETRY_BATCH_HEADER_LEN) return false;
+        buf[7] |= flags;
+        return true;
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,171 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Quadro binário de telemetria trocado entre transmissor e receptor.
+// Mesmo arquivo nas duas estações; sem dependência do SDK (compila no host).
+//
+// Leitura única (TELEMETRY_TYPE_READING), 12 bytes, little-endian:
+//   [0]     versão (4 bits altos) | tipo (4 bits baixos)
+//   [1]     id do nó
+//   [2..3]  número de sequência
+//   [4]     flags de validade
+//   [5..6]  temperatura, centésimos de °C (int16)
+//   [7..8]  umidade relativa, centésimos de % (uint16)
+//   [9..11] pressão, Pa (uint24)
+//
+// Lote de amostras (TELEMETRY_TYPE_BATCH), tamanho variável:
+//   [0]     versão | tipo
+//   [1]     id do nó
+//   [2..3]  sequência da primeira amostra (as demais são consecutivas)
+//   [4]     número de amostras N (1..TELEMETRY_BATCH_MAX)
+//   [5..6]  intervalo entre amostras, ms
+//   [7]     flags de validade (valem para o lote inteiro)
+//   [8..14] primeira amostra: temperatura (int16), umidade (uint16), pressão (uint24)
+//   [15..]  amostras 2..N: diferença em relação à primeira, em varint zigzag,
+//           na ordem temperatura, umidade, pressão (1 byte cada em regime estável)
+//
+// Comando ADR do receptor para um nó (TELEMETRY_TYPE_ADR), 6 bytes:
+//   [0]     versão | tipo
+//   [1]     id do nó de destino
+//   [2..3]  sequência do quadro que motivou o comando
+//   [4]     spreading factor a usar a partir do próximo quadro
+//   [5]     potência de transmissão, dBm (int8)
+//
+// Confirmação do receptor (TELEMETRY_TYPE_ACK), 8 bytes, ou 10 com ADR:
+//   [0]     versão | tipo
+//   [1]     id do nó de destino
+//   [2..3]  maior sequência recebida do nó
+//   [4..7]  bitmap: bit i = sequência (maior - i) recebida (bit 0 é a própria maior)
+//   [8]     opcional: spreading factor (mesmo significado do comando ADR)
+//   [9]     opcional: potência de transmissão, dBm (int8)
+//
+// Beacon de sincronismo TDMA do receptor (TELEMETRY_TYPE_BEACON), 12 + N bytes:
+//   [0]     versão | tipo
+//   [1..4]  relógio do receptor (ms) no fim da transmissão do beacon
+//   [5..6]  período do superquadro, ms (de um beacon ao próximo)
+//   [7..8]  duração de cada slot, ms
+//   [9..10] início do slot 0, ms após o fim do beacon
+//   [11]    número de slots N (0..TELEMETRY_BEACON_MAX_SLOTS)
+//   [12..]  id do nó dono de cada slot
+
+#define TELEMETRY_VERSION       1
+
+#define TELEMETRY_TYPE_READING  0x1
+#define TELEMETRY_TYPE_BATCH    0x2
+#define TELEMETRY_TYPE_ADR      0x3
+#define TELEMETRY_TYPE_ACK      0x4
+#define TELEMETRY_TYPE_BEACON   0x5
+
+// Flags de validade
+#define TELEMETRY_FLAG_AHT_OK   0x01    // Temperatura e umidade válidas
+#define TELEMETRY_FLAG_BMP_OK   0x02    // Pressão válida
+#define TELEMETRY_FLAG_ACK_REQ  0x40    // Nó aguarda TELEMETRY_TYPE_ACK na janela de recepção
+#define TELEMETRY_FLAG_ADR_ACK_REQ 0x80 // Nó sem comando ADR há muito tempo: pede resposta
+
+#define TELEMETRY_READING_LEN   12
+#define TELEMETRY_ADR_LEN       6
+#define TELEMETRY_ACK_LEN       8
+#define TELEMETRY_ACK_ADR_LEN   10
+
+#define TELEMETRY_BEACON_HEADER_LEN 12
+#define TELEMETRY_BEACON_MAX_SLOTS  32
+#define TELEMETRY_BEACON_MAX_LEN    (TELEMETRY_BEACON_HEADER_LEN + TELEMETRY_BEACON_MAX_SLOTS)
+
+// Maior quadro enviado pelo receptor na janela de recepção do nó
+#define TELEMETRY_DOWNLINK_MAX_LEN  TELEMETRY_ACK_ADR_LEN
+
+// Lote: cabeçalho + primeira amostra, e o pior caso de cada amostra seguinte
+#define TELEMETRY_BATCH_MAX         16
+#define TELEMETRY_BATCH_HEADER_LEN  15
+#define TELEMETRY_BATCH_MAX_LEN     (TELEMETRY_BATCH_HEADER_LEN + (TELEMETRY_BATCH_MAX - 1) * 10)
+
+typedef struct {
+    uint8_t node_id;
+    uint16_t seq;
+    uint8_t flags;
+    int16_t temp_cdeg;        // 0,01 °C
+    uint16_t humidity_cpct;   // 0,01 %
+    uint32_t pressure_pa;     // Pa (até 16 777 215)
+} telemetry_reading_t;
+
+// Uma amostra dentro de um lote
+typedef struct {
+    int16_t temp_cdeg;
+    uint16_t humidity_cpct;
+    uint32_t pressure_pa;
+} telemetry_sample_t;
+
+typedef struct {
+    uint8_t node_id;
+    uint16_t seq_first;
+    uint16_t interval_ms;
+    uint8_t flags;
+    uint8_t count;
+    telemetry_sample_t samples[TELEMETRY_BATCH_MAX];
+} telemetry_batch_t;
+
+typedef struct {
+    uint8_t node_id;
+    uint16_t seq;
+    uint8_t sf;
+    int8_t tx_power_dbm;
+} telemetry_adr_t;
+
+typedef struct {
+    uint8_t node_id;
+    uint16_t last_seq;
+    uint32_t bitmap;
+    bool has_adr;             // Carrega também um comando ADR
+    uint8_t sf;
+    int8_t tx_power_dbm;
+} telemetry_ack_t;
+
+typedef struct {
+    uint32_t gateway_ms;
+    uint16_t period_ms;
+    uint16_t slot_ms;
+    uint16_t offset_ms;
+    uint8_t slot_count;
+    uint8_t slots[TELEMETRY_BEACON_MAX_SLOTS];
+} telemetry_beacon_t;
+
+// Serializa uma leitura; retorna o tamanho do quadro ou 0 se não couber em buf
+size_t telemetry_encode(const telemetry_reading_t *r, uint8_t *buf, size_t buf_len);
+
+// Desserializa uma leitura; false se versão, tipo ou tamanho não conferem
+bool telemetry_decode(const uint8_t *buf, size_t len, telemetry_reading_t *out);
+
+// Serializa/desserializa um lote (mesmas regras de retorno da leitura única)
+size_t telemetry_encode_batch(const telemetry_batch_t *b, uint8_t *buf, size_t buf_len);
+bool telemetry_decode_batch(const uint8_t *buf, size_t len, telemetry_batch_t *out);
+
+// Serializa/desserializa um comando ADR
+size_t telemetry_encode_adr(const telemetry_adr_t *a, uint8_t *buf, size_t buf_len);
+bool telemetry_decode_adr(const uint8_t *buf, size_t len, telemetry_adr_t *out);
+
+// Serializa/desserializa uma confirmação
+size_t telemetry_encode_ack(const telemetry_ack_t *a, uint8_t *buf, size_t buf_len);
+bool telemetry_decode_ack(const uint8_t *buf, size_t len, telemetry_ack_t *out);
+
+// Serializa/desserializa um beacon
+size_t telemetry_encode_beacon(const telemetry_beacon_t *b, uint8_t *buf, size_t buf_len);
+bool telemetry_decode_beacon(const uint8_t *buf, size_t len, telemetry_beacon_t *out);
+
+// Slot do nó no beacon ou -1 se não tiver um
+int telemetry_beacon_slot(const telemetry_beacon_t *b, uint8_t node_id);
+
+// Sequências transportadas por um quadro de leitura ou lote
+bool telemetry_frame_seq(const uint8_t *buf, size_t len, uint16_t *seq_first, uint8_t *count);
+
+// Tipo do quadro (TELEMETRY_TYPE_*) ou 0 se vazio ou de outra versão
+uint8_t telemetry_frame_type(const uint8_t *buf, size_t len);
+
+// Liga 'flags' no byte de flags de um quadro já serializado (leitura ou lote);
+// false se o quadro não tiver esse campo
+bool telemetry_set_flags(uint8_t *buf, size_t len, uint8_t flags);
+
+#endif